@@ -10,6 +10,10 @@
 #include <mpi.h>
 #include <omp.h>
 
+#include <sys/resource.h>
+#include <sys/time.h>
+#include <unistd.h>
+
 #include <parasail.h>
 #include <parasail/io.h>
 
@@ -19,39 +23,98 @@
 #include <cctype>
 #include <cfloat>
 #include <climits>
+#include <cmath>
 #include <cstdio>
 #include <cstdlib>
 #include <cstring>
 #include <fstream>
 #include <iostream>
-#include <set>
+#include <list>
 #include <stack>
+#include <string>
 #include <utility>
 #include <vector>
 
 /* pgraph contrib headers */
 #include "sais.h"
+#include "sais_omp.hpp"
+#include "radix_sort.hpp"
 
 /* pgraph headers */
 #include "AlignStats.hpp"
 #include "alignment.hpp"
 #include "combinations.h"
 #include "EdgeResult.hpp"
+#include "esa_traversal.hpp"
+#include "FMIndex.hpp"
 #include "Bootstrap.hpp"
 #include "mpix.hpp"
 #include "mpix_types.hpp"
+#include "MinimizerIndex.hpp"
+#include "PairQueue.hpp"
 #include "Parameters.hpp"
 #include "SuffixArrayStats.hpp"
+#include "TileWorkspace.hpp"
 #include "nxtval.h"
+#include "pairsteal.h"
 
 using namespace ::std;
 using namespace ::pgraph;
 
 #define NUM_WORKERS omp_get_max_threads()
-typedef pair<int,int> Pair;
 
-typedef set<Pair> PairSet;
-typedef vector<Pair> PairVec;
+/* pairs each thread claims at a time from a tile open to stealing */
+#define STEAL_CLAIM_PER_WORKER 32
+
+/* microseconds a thread waits for a batch while others still traverse */
+#define PAIR_STREAM_BACKOFF 20
+
+/* The banded kernel is scalar while the parasail ones are vectorized, so
+ * a pair is only banded when its full matrix has this many times the
+ * cells of the band. */
+#define BAND_MIN_SAVING 16
+
+/* Bytes per residue of a tile's ESA while it is sorted: the suffix array,
+ * the LCPs as built, the clamped int LCPs, the BWT, the sequence id of
+ * every suffix, and the rank of every suffix that sais_omp allocates for
+ * its LCP pass. The 32-bit path clamps its LCPs in place, so holds one LCP
+ * array. sais needs only alphabet-sized scratch, so the diagonal tiles it
+ * sorts take ESA_SCRATCH_NARROW less; sais_omp's bucket counts, 66049
+ * indices per thread, do not grow with the tile. */
+#define ESA_SCRATCH_NARROW sizeof(int)
+#define ESA_SCRATCH_WIDE sizeof(long)
+#define ESA_BYTES_NARROW (2*sizeof(int) + sizeof(unsigned char) + sizeof(int) + ESA_SCRATCH_NARROW)
+#define ESA_BYTES_WIDE (2*sizeof(long) + sizeof(int) + sizeof(unsigned char) + sizeof(int) + ESA_SCRATCH_WIDE)
+
+/* suffix array and clamped LCP array of a single block, or of a sample of
+ * its suffixes; int ones are kept so every tile containing the block can
+ * merge them instead of sorting again */
+template <class Index>
+struct BlockESA {
+    size_t block;
+    vector<Index> SA;
+    vector<Index> LCP;
+};
+
+/* the query profile a thread built last, kept while its pairs share
+ * their first sequence */
+struct QueryProfile {
+    int sid;
+    parasail_profile_t *profile;
+
+    QueryProfile()
+        : sid(-1), profile(NULL) {}
+};
+
+/* the seeds of the sequence a thread banded last, kept like its query
+ * profile while its pairs share their first sequence */
+struct QuerySeeds {
+    int sid;
+    BandWorkspace workspace;
+
+    QuerySeeds()
+        : sid(-1), workspace() {}
+};
 
 typedef struct {
     int rank;
@@ -63,67 +126,254 @@ typedef struct {
     int *SID;
     vector<long> *BEG;
     vector<long> *END;
+    vector<int> *SELF; /* self score of each sequence */
     char sentinal;
     vector<EdgeResult> *edge_results;
+    vector<EdgeResult> *edge_results_spare; /* written while the other aligns */
     ofstream *edge_out;
     ofstream *debug_out;
     Parameters *parameters;
     parasail_function_t *aligner;
+    parasail_pfunction_t *paligner; /* NULL unless profiles are reused */
+    parasail_pcreator_t *pcreator;
+    vector<QueryProfile> profiles; /* one per worker */
+    parasail_function_t *screen; /* score-only, NULL if pairs are not screened */
+    parasail_pfunction_t *pscreen;
+    parasail_pcreator_t *pscreen_creator;
+    vector<QueryProfile> screen_profiles; /* one per worker */
+    int band; /* half width of the band around the seed, 0 if not banded */
+    vector<QuerySeeds> seeds; /* one per worker */
     const parasail_matrix_t *matrix;
+    long parts;
+    long tiles;
+    vector<long long> tile_order; /* task_id served for each NXTVAL index */
+    vector<double> tile_costs; /* predicted cost, indexed by task_id+parts */
+    list<BlockESA<int> > block_esa; /* most recently used first */
+    vector<vector<uint64_t> > block_signatures; /* k-mer bitmap per block */
+    TileWorkspace *workspace; /* scratch buffers reused across tiles */
+    vector<long> block_start; /* first sequence of each block, then the count */
+    size_t pair_compact; /* keys a chunk's pair buffer holds before compacting */
+    STEAL_t *steal; /* pairs of large tiles open to other ranks */
+    vector<uint64_t> mask; /* bit per residue of a low-complexity region */
+    MinimizerIndex *minimizers; /* whole-database seeds, NULL for the ESA */
+    FMIndex *fm_index; /* whole database, NULL unless FilterEngine fmindex */
 } local_data_t;
 
-struct quad {
-    int lcp;
-    int lb;
-    int rb;
-    vector<quad> children;
+/* slots of the tile workspace */
+enum {
+    WS_SID_SA,
+    WS_SA,
+    WS_LCP,
+    WS_LCP_WIDE,
+    WS_BWT,
+    WS_SEEN
+};
+
+/* A tile as the two contiguous ranges of the packed sequences holding its
+ * blocks; a diagonal tile leaves the second range empty. Tile position p
+ * is sequences[global(p)]. */
+struct TileView {
+    const char *sequences;
+    long beg[2];
+    long len[2];
+
+    long n() const { return len[0] + len[1]; }
+    long global(long p) const {
+        return p < len[0] ? beg[0] + p : beg[1] - len[0] + p;
+    }
+    char at(long p) const { return sequences[global(p)]; }
+    const char *segment(int s) const { return &sequences[beg[s]]; }
+};
+
+/* The residues of an off-diagonal tile as sais_omp reads them: text[p] is
+ * view.at(p), with both segments' addresses worked out once so the sorting
+ * loops only pick one of two pointers. */
+struct TileText {
+    const char *head;
+    const char *tail; /* the second segment, less the first's length */
+    long len_head;
+
+    explicit TileText(const TileView &view)
+        : head(view.segment(0))
+        , tail(view.segment(1) - view.len[0])
+        , len_head(view.len[0]) {}
 
-    quad()
-        : lcp(0), lb(0), rb(INT_MAX), children() {}
-    quad(int lcp, int lb, int rb)
-        : lcp(lcp), lb(lb), rb(rb), children() {}
-    quad(int lcp, int lb, int rb, vector<quad> children)
-        : lcp(lcp), lb(lb), rb(rb), children(children) {}
+    char operator[](long p) const { return (p < len_head ? head : tail)[p]; }
+};
+
+/* A tile whose pairs are aligned in batches while its ESA is traversed.
+ * The first sequence of a pair lies in [first_beg, first_beg+first_count)
+ * and the second in [second_beg, second_beg+second_count); seen holds one
+ * bit per such pair, so a pair found by several threads is aligned once. */
+struct PairStream {
+    local_data_t *local_data;
+    PairQueue *queue;
+    uint64_t *seen;
+    long first_beg;
+    long second_beg;
+    long second_count;
+    size_t batch;
+    unsigned long unique;
+    unsigned long full;
+
+    /* the pair sink of lcp_intervals */
+    void added(PairVec &pairs);
+    void finished(PairVec &pairs);
+};
 
-    bool empty() { return rb == INT_MAX; }
+/* orders task ids by decreasing predicted cost */
+struct TileCostGreater {
+    const vector<double> &costs;
+    long parts;
+    TileCostGreater(const vector<double> &costs, long parts)
+        : costs(costs), parts(parts) {}
+    bool operator()(const long long &a, const long long &b) const {
+        return costs[a+parts] > costs[b+parts];
+    }
 };
 
+/* chunks per thread a tile's ESA is traversed in; see SA_filter */
+#define ESA_CHUNKS_PER_WORKER 4
+
+/* keys per candidate pair held at once while a tile's pairs are gathered:
+ * the chunk buffers, up to twice their pairs after doubling, and the
+ * gathered vector, which radix_sort_unique then copies */
+#define PAIR_PEAK_KEYS 3
+
+/* fewest keys a chunk's pair buffer holds before compacting under a
+ * memory budget */
+#define PAIR_COMPACT_MIN 4096
+
+/* rough cost, in cell updates, of building and traversing the ESA per
+ * residue of a tile; keeps tiny tiles from all tying at zero */
+#define TILE_COST_PER_RESIDUE 64.0
+
+/* widest guarded intervals of a tile written to the debug output */
+#define HEAVY_INTERVAL_REPORT 8
+
 static int inner_main(int argc, char **argv);
 
-static void pair_check(
-        unsigned long &count_generated,
-        PairSet &pairs,
-        const int &i,
-        const int &j,
-        const int * const restrict SA,
-        const unsigned char * const restrict BWT,
-        const int * const restrict SID,
-        int sid_crossover,
-        const char &sentinal);
-
-static void process(
-        unsigned long &count_generated,
-        PairSet &pairs,
-        const quad &q,
-        const int * const restrict SA,
-        const unsigned char * const restrict BWT,
-        const int * const restrict SID,
+static void stream_batch(PairStream *stream, PairVec &pairs);
+
+static void align_batch(local_data_t *local_data, const PairVec &pairs);
+
+static double SA_filter(
+        local_data_t *local_data,
+        const TileView &view,
         int sid_crossover,
-        const char &sentinal,
-        const int &cutoff);
+        int cutoff,
+        size_t id1,
+        size_t id2,
+        SuffixArrayStats &stats_sa,
+        PairVec &vpairs,
+        bool stream,
+        int step);
+
+static void build_esa(
+        local_data_t *local_data,
+        const char *T,
+        long n,
+        int *SA,
+        int *LCP);
+
+static void build_esa(
+        local_data_t *local_data,
+        const char *T,
+        long n,
+        long *SA,
+        long *LCP);
+
+template <class Index>
+static void build_esa(
+        local_data_t *local_data,
+        const TileView &view,
+        Index *SA,
+        Index *LCP);
+
+template <class Index, class Built>
+static void finish_esa(
+        local_data_t *local_data,
+        const TileView &view,
+        long n,
+        const Index *SA,
+        const Built *LCP_built,
+        int *LCP,
+        unsigned char *BWT,
+        int *SID_SA,
+        char &first,
+        char &last);
+
+template <class Index>
+static void build_block_esa(
+        local_data_t *local_data,
+        const char *T,
+        long n,
+        BlockESA<Index> &esa);
+
+static const BlockESA<int>* get_block_esa(
+        local_data_t *local_data,
+        size_t block,
+        const char *T,
+        long n);
 
-static void SA_filter(
+static const BlockESA<int>* other_block_esa(
         local_data_t *local_data,
-        int *SID,
+        size_t block,
         const char *T,
         long n,
+        BlockESA<int> &esa);
+
+static const BlockESA<long>* other_block_esa(
+        local_data_t *local_data,
+        size_t block,
+        const char *T,
+        long n,
+        BlockESA<long> &esa);
+
+template <class Index>
+static void merge_esa(
+        const char *T1,
+        const BlockESA<Index> &esa1,
+        const char *T2,
+        const BlockESA<Index> &esa2,
         char sentinal,
-        int sid_crossover,
-        int cutoff,
-        SuffixArrayStats &stats_sa);
+        long n1,
+        Index *SA,
+        int *LCP);
+
+template <class Index>
+static void sample_esa(
+        local_data_t *local_data,
+        long beg,
+        long n,
+        int step,
+        BlockESA<Index> &sampled);
+
+template <class Index>
+static long sparse_esa(
+        local_data_t *local_data,
+        const TileView &view,
+        size_t id1,
+        size_t id2,
+        int step,
+        bool sample_first,
+        Index *&SA,
+        int *&LCP,
+        double &bytes);
 
 static string get_edges_filename(int rank);
 
+static string screen_function(const Parameters *parameters);
+
+static const parasail_profile_t* query_profile(
+        QueryProfile &query,
+        parasail_pcreator_t *pcreator,
+        int sid,
+        const char *seq,
+        int len,
+        const parasail_matrix_t *matrix,
+        AlignStats &stats);
+
 static string get_debug_filename(int rank);
 
 static bool length_filter(size_t s1Len, size_t s2Len, size_t cutOff);
@@ -134,8 +384,110 @@ static void alignment_task(
         local_data_t *local_data,
         int thd);
 
+static bool passes_screen(
+        local_data_t *local_data,
+        size_t i,
+        size_t j,
+        int thd,
+        int &score);
+
+static bool align_in_band(
+        local_data_t *local_data,
+        size_t i,
+        size_t j,
+        int score,
+        parasail_result_t &result,
+        int thd);
+
 static void sa_task(long long task_id, local_data_t *local_data);
 
+static double filter_task(
+        long long task_id,
+        local_data_t *local_data,
+        PairVec &vpairs,
+        bool stream);
+
+static double align_pairs(
+        local_data_t *local_data,
+        const uint64_t *pairs,
+        long long count);
+
+static void steal_tasks(local_data_t *local_data);
+
+static void query_filter(
+        local_data_t *local_data,
+        size_t block,
+        SuffixArrayStats &stats_sa,
+        PairVec &vpairs);
+
+static size_t fm_partners(local_data_t *local_data, long s, vector<int> &ids,
+        unsigned long &heavy);
+
+static void write_edges(
+        local_data_t *local_data,
+        vector<EdgeResult> *edge_results);
+
+static bool get_task(
+        NXTVAL_t *nxt,
+        local_data_t *local_data,
+        long long &task_id);
+
+static void pipelined_tasks(NXTVAL_t *nxt, local_data_t *local_data);
+
+static void report_tile_cost(
+        local_data_t *local_data,
+        long long task_id,
+        unsigned long work,
+        double seconds);
+
+static void task_blocks(long long task_id, size_t &id1, size_t &id2);
+
+static void block_range(
+        local_data_t *local_data,
+        size_t block,
+        size_t &seq_beg,
+        size_t &seq_end);
+
+static double tile_bytes(
+        local_data_t *local_data,
+        double residues,
+        double pairs);
+
+static void budget_blocks(
+        local_data_t *local_data,
+        size_t budget,
+        vector<long> &block_start);
+
+static void report_blocks(local_data_t *local_data, size_t budget);
+
+static void tile_costs(
+        local_data_t *local_data,
+        long parts,
+        long tiles,
+        int samples,
+        vector<double> &costs);
+
+static void block_signatures(
+        local_data_t *local_data,
+        long parts,
+        int bits,
+        vector<vector<uint64_t> > &signatures);
+
+static unsigned long mask_low_complexity(
+        local_data_t *local_data,
+        int window,
+        double entropy,
+        vector<uint64_t> &mask);
+
+static inline bool is_masked(const vector<uint64_t> &mask, long g)
+{
+    return (mask[g/64] >> (g%64)) & 1;
+}
+
+static bool signatures_intersect(
+        const vector<uint64_t> &a,
+        const vector<uint64_t> &b);
+
 
 int main(int argc, char **argv)
 {
@@ -176,6 +528,7 @@ static int inner_main(int argc, char **argv)
     int *SID = NULL;
     vector<long> BEG;
     vector<long> END;
+    vector<int> SELF;
     char sentinal = 0;
     int cutoff = 7;
 
@@ -188,7 +541,7 @@ static int inner_main(int argc, char **argv)
     /* initialize global data */
     stats_align = new AlignStats[NUM_WORKERS];
     stats_sa = new SuffixArrayStats;
-    edge_results = new vector<EdgeResult>[NUM_WORKERS];
+    edge_results = new vector<EdgeResult>[NUM_WORKERS*2];
     parameters = new Parameters;
     local_data = new local_data_t;
     local_data->rank = rank;
@@ -196,9 +549,15 @@ static int inner_main(int argc, char **argv)
     local_data->stats_align = stats_align;
     local_data->stats_sa = stats_sa;
     local_data->edge_results = edge_results;
+    local_data->edge_results_spare = edge_results + NUM_WORKERS;
     local_data->edge_out = NULL;
     local_data->debug_out = NULL;
     local_data->parameters = parameters;
+    local_data->workspace = NULL;
+    local_data->minimizers = NULL;
+    local_data->fm_index = NULL;
+    local_data->steal = NULL;
+    local_data->pair_compact = PAIR_COMPACT_SIZE;
 
     /* MPI standard does not guarantee all procs receive argc and arg */
     all_argv = mpix::bcast(argc, argv, pgraph::comm);
@@ -261,6 +620,96 @@ static int inner_main(int argc, char **argv)
         pgraph::finalize();
         return 1;
     }
+    /* Pairs are sorted by their first sequence, so a thread usually aligns
+     * a run of partners against the same query. Functions without a
+     * profile variant, e.g. the non-vectorized ones, build none. */
+    local_data->paligner = NULL;
+    local_data->pcreator = NULL;
+    if (parameters->reuse_query_profile) {
+        string pfunction = profile_function(parameters->function);
+        local_data->paligner = parasail_lookup_pfunction(pfunction.c_str());
+        local_data->pcreator = parasail_lookup_pcreator(pfunction.c_str());
+        if (NULL == local_data->paligner || NULL == local_data->pcreator) {
+            local_data->paligner = NULL;
+            local_data->pcreator = NULL;
+            if (0 == rank) {
+                cout << parameters->function
+                    << " has no profile variant, query profiles not reused"
+                    << endl;
+            }
+        }
+    }
+    local_data->profiles.resize(NUM_WORKERS);
+
+    /* A pair whose optimal score is below OS percent of the self score
+     * is never an edge, and a score-only kernel finds that score far
+     * faster than one also counting matches and length. Saturated
+     * scores are lower bounds, so those pairs are aligned in full. When
+     * every alignment is written there is nothing to skip. */
+    local_data->screen = NULL;
+    local_data->pscreen = NULL;
+    local_data->pscreen_creator = NULL;
+    if (parameters->align_screen && !parameters->output_all) {
+        string screen = screen_function(parameters);
+        if (screen != parameters->function) {
+            local_data->screen = parasail_lookup_function(screen.c_str());
+        }
+        if (NULL == local_data->screen) {
+            if (0 == rank) {
+                cout << "no screen function " << screen
+                    << ", pairs not screened" << endl;
+            }
+        }
+        else {
+            if (0 == rank) {
+                cout << "screening pairs with " << screen << endl;
+            }
+            if (NULL != local_data->paligner) {
+                string pscreen = profile_function(screen);
+                local_data->pscreen =
+                    parasail_lookup_pfunction(pscreen.c_str());
+                local_data->pscreen_creator =
+                    parasail_lookup_pcreator(pscreen.c_str());
+                if (NULL == local_data->pscreen
+                        || NULL == local_data->pscreen_creator) {
+                    local_data->pscreen = NULL;
+                    local_data->pscreen_creator = NULL;
+                }
+            }
+        }
+    }
+    local_data->screen_profiles.resize(NUM_WORKERS);
+
+    /* Homologous pairs align along the diagonal of their exact matches,
+     * so long pairs are first aligned only near it. A banded alignment is
+     * only kept if it scores as well as the full one, which the screen
+     * has already found. The banded kernel is a local alignment, so other
+     * functions align every pair in full. */
+    local_data->band = 0;
+    if (parameters->band_width > 0) {
+        if (0 != parameters->function.compare(0, 3, "sw_")) {
+            if (0 == rank) {
+                cout << parameters->function
+                    << " is not a local alignment, pairs not banded" << endl;
+            }
+        }
+        else if (NULL == local_data->screen) {
+            if (0 == rank) {
+                cout << "BandWidth needs the score-only screen,"
+                    << " pairs not banded" << endl;
+            }
+        }
+        else {
+            local_data->band = parameters->band_width;
+            if (0 == rank) {
+                cout << "banding long pairs within " << local_data->band
+                    << " of their seed diagonal;"
+                    << " an edge may report another optimal alignment"
+                    << endl;
+            }
+        }
+    }
+    local_data->seeds.resize(NUM_WORKERS);
 
     time = MPI_Wtime();
     mpix::read_file(all_argv[1], file_buffer, file_size, pgraph::comm);
@@ -345,6 +794,90 @@ static int inner_main(int argc, char **argv)
     local_data->END = &END;
     local_data->sentinal = sentinal;
 
+    /* is_edge needs the self score of both sequences of every pair */
+    time = MPI_Wtime();
+    SELF.resize(sid);
+#pragma omp parallel for schedule(dynamic, 256)
+    for (long s=0; s<sid; ++s) {
+        SELF[s] = self_score(&packed_buffer[BEG[s]], END[s]-BEG[s],
+                local_data->matrix);
+    }
+    time = MPI_Wtime() - time;
+    local_data->SELF = &SELF;
+    if (0 == rank) {
+        cout << "time self scores " << time << endl;
+    }
+
+    /* masked residues still align, they just never start a seed */
+    if (parameters->mask_low_complexity) {
+        unsigned long masked = 0;
+        long residues = packed_size - sid;
+        time = MPI_Wtime();
+        masked = mask_low_complexity(local_data,
+                parameters->mask_window, parameters->mask_entropy,
+                local_data->mask);
+        time = MPI_Wtime() - time;
+        if (0 == rank) {
+            cout << "masked residues " << masked
+                << " of " << residues
+                << " (" << 100.0*masked/residues << "%)" << endl;
+            cout << "time low complexity mask " << time << endl;
+        }
+    }
+
+    if (parameters->filter_engine != "esa"
+            && parameters->filter_engine != "minimizer"
+            && parameters->filter_engine != "fmindex") {
+        if (0 == rank) {
+            fprintf(stderr, "unknown FilterEngine '%s'\n",
+                    parameters->filter_engine.c_str());
+        }
+        exit(EXIT_FAILURE);
+    }
+
+    /* Every rank indexes the whole database once instead of building an
+     * ESA per tile. By default a window spans exactly cutoff residues, so
+     * any pair the ESA would find shares a minimizer. */
+    if (parameters->filter_engine == "minimizer") {
+        int k = parameters->minimizer_k;
+        int w = parameters->minimizer_window;
+        if (k <= 0) {
+            k = max(1, cutoff - 2);
+        }
+        k = min(k, MinimizerIndex::MAX_K);
+        if (w <= 0) {
+            w = max(1, cutoff - k + 1);
+        }
+        time = MPI_Wtime();
+        local_data->minimizers = new MinimizerIndex(packed_buffer, BEG, END,
+                k, w, local_data->mask,
+                parameters->minimizer_max_sequences);
+        time = MPI_Wtime() - time;
+        if (0 == rank) {
+            const MinimizerIndex *index = local_data->minimizers;
+            cout << "minimizer index k=" << index->k()
+                << " w=" << index->w()
+                << ": " << index->minimizers() << " shared minimizers, "
+                << index->entries() << " entries, "
+                << index->dropped() << " dropped, "
+                << index->bytes() << " bytes" << endl;
+            cout << "time minimizer index " << time << endl;
+        }
+    }
+
+    /* one index of the whole database replaces every tile's ESA */
+    if (parameters->filter_engine == "fmindex") {
+        time = MPI_Wtime();
+        local_data->fm_index = new FMIndex(packed_buffer, packed_size,
+                parameters->fm_index_sample);
+        time = MPI_Wtime() - time;
+        if (0 == rank) {
+            cout << "fm index: " << local_data->fm_index->rows() << " rows, "
+                << local_data->fm_index->bytes() << " bytes" << endl;
+            cout << "time fm index " << time << endl;
+        }
+    }
+
     /* how many combinations of sequences are there? */
     unsigned long ntasks = binomial_coefficient(sid, 2);
     if (0 == rank) {
@@ -356,35 +889,111 @@ static int inner_main(int argc, char **argv)
             << endl;
     }
 
-    while (sid % parameters->sa_block_size == 1) {
-        if (0 == rank) {
-            cout << "sa_block_size parameter left a remainder of 1; increasing by 1" << endl;
-            parameters->sa_block_size += 1;
+    long parts = 0;
+    if (parameters->sa_block_budget) {
+        /* Half the budget bounds the pairs found more than once, which
+         * stay in the chunk buffers until compacted. */
+        local_data->pair_compact = max(size_t(PAIR_COMPACT_MIN),
+                parameters->memory_worker / 2
+                / (PAIR_PEAK_KEYS*sizeof(uint64_t))
+                / (ESA_CHUNKS_PER_WORKER*NUM_WORKERS));
+        /* every rank derives the same block map from BEG/END */
+        budget_blocks(local_data, parameters->memory_worker,
+                local_data->block_start);
+        parts = local_data->block_start.size() - 1;
+    }
+    else {
+        while (sid % parameters->sa_block_size == 1) {
+            if (0 == rank) {
+                cout << "sa_block_size parameter left a remainder of 1; increasing by 1" << endl;
+                parameters->sa_block_size += 1;
+            }
         }
+        parts = (sid + parameters->sa_block_size - 1) / parameters->sa_block_size;
     }
-
-    long parts = (sid + parameters->sa_block_size - 1) / parameters->sa_block_size;
     long tiles = parts*(parts-1)/2;
+    /* a whole-database engine pairs each block with every later sequence,
+     * so only the diagonal task ids are drawn */
+    if (parameters->filter_engine != "esa") {
+        tiles = 0;
+    }
+    local_data->parts = parts;
+    local_data->tiles = tiles;
     if (0 == rank) {
         printf("sequences split into %ld parts, %ld off-diagonal tiles\n",
                 parts, tiles);
     }
+    if (parameters->sa_block_budget) {
+        report_blocks(local_data, parameters->memory_worker);
+    }
+
+    local_data->workspace = new TileWorkspace(parameters->workspace_huge_pages);
+
+    /* optionally serve tiles longest-processing-time first; every rank
+     * computes the same deterministic permutation so nothing is sent */
+    if (parameters->tile_order_lpt) {
+        vector<double> costs;
+        time = MPI_Wtime();
+        tile_costs(local_data, parts, tiles, parameters->tile_cost_samples, costs);
+        vector<long long> &tile_order = local_data->tile_order;
+        tile_order.resize(parts+tiles);
+        for (long long t=0; t<parts+tiles; ++t) {
+            tile_order[t] = t - parts;
+        }
+        stable_sort(tile_order.begin(), tile_order.end(),
+                TileCostGreater(costs, parts));
+        local_data->tile_costs.swap(costs);
+        time = MPI_Wtime() - time;
+        if (0 == rank) {
+            cout << "time tile cost model " << time << endl;
+        }
+    }
+
+    /* every rank keeps the signatures of all blocks since any rank may
+     * draw any tile */
+    if (parameters->tile_prefilter && tiles > 0) {
+        time = MPI_Wtime();
+        block_signatures(local_data, parts,
+                parameters->tile_prefilter_bits,
+                local_data->block_signatures);
+        time = MPI_Wtime() - time;
+        if (0 == rank) {
+            cout << "time tile signatures " << time << endl;
+        }
+    }
 
     MPI_Barrier(pgraph::comm);
 
     {
-        long long index;
-        NXTVAL_t nxt = NXTVAL_init(-parts, tiles);
-        index = NXTVAL_get(nxt);
-        (*local_data->debug_out) << "NXTVAL_get: " << index << endl;
-        while (index < tiles) {
-            sa_task(index, local_data);
-            index = NXTVAL_get(nxt);
-            (*local_data->debug_out) << "NXTVAL_get: " << index << endl;
+        long long task_id;
+        int provided;
+        /* rank 0 serving NXTVAL never draws a tile, and must create the
+         * stealing window before it blocks in NXTVAL_init */
+        MPI_Query_thread(&provided);
+        STEAL_t steal = STEAL_init(parameters->pair_steal_threshold,
+                nprocs > 1 && 0 == rank && !parameters->nxtval_rma
+                && MPI_THREAD_MULTIPLE != provided);
+        local_data->steal = &steal;
+        NXTVAL_t nxt = NXTVAL_init(-parts, tiles,
+                parameters->nxtval_rma ?
+                    NXTVAL_BACKEND_RMA : NXTVAL_BACKEND_SERVER,
+                parameters->nxtval_guided ?
+                    NXTVAL_CHUNK_GUIDED : NXTVAL_CHUNK_SINGLE,
+                parameters->nxtval_chunk_min);
+        if (parameters->pipeline_tiles) {
+            pipelined_tasks(&nxt, local_data);
         }
+        else {
+            while (get_task(&nxt, local_data, task_id)) {
+                sa_task(task_id, local_data);
+            }
+        }
+        steal_tasks(local_data);
 
         (*local_data->debug_out) << "NXTVAL_stop" << endl;
         NXTVAL_stop(nxt);
+        STEAL_stop(steal);
+        local_data->steal = NULL;
     }
 
 
@@ -400,6 +1009,13 @@ static int inner_main(int argc, char **argv)
             Stats time_total;
             Stats work;
             Stats work_skipped;
+            Stats profiles;
+            Stats time_profile;
+            Stats screened;
+            Stats rejected;
+            Stats time_screen;
+            Stats banded;
+            Stats unbanded;
             ostringstream header;
             int p = cout.precision();
 
@@ -418,6 +1034,13 @@ static int inner_main(int argc, char **argv)
                 time_total.push_back(rstats[i].time_total);
                 work.push_back(rstats[i].work);
                 work_skipped.push_back(rstats[i].work_skipped);
+                profiles.push_back(rstats[i].profiles);
+                time_profile.push_back(rstats[i].time_profile);
+                screened.push_back(rstats[i].screened);
+                rejected.push_back(rstats[i].rejected);
+                time_screen.push_back(rstats[i].time_screen);
+                banded.push_back(rstats[i].banded);
+                unbanded.push_back(rstats[i].unbanded);
                 cout << right << setw(5) << i << rstats[i] << endl;
             }
             Stats::width(21);
@@ -431,6 +1054,13 @@ static int inner_main(int argc, char **argv)
             cout << "     TTotal" << time_total << endl;
             cout << "       Work" << work << endl;
             cout << "WorkSkipped" << work_skipped << endl;
+            cout << "   Profiles" << profiles << endl;
+            cout << "   TProfile" << time_profile << endl;
+            cout << "   Screened" << screened << endl;
+            cout << "   Rejected" << rejected << endl;
+            cout << "    TScreen" << time_screen << endl;
+            cout << "     Banded" << banded << endl;
+            cout << "   Unbanded" << unbanded << endl;
             cout << string(79, '-') << endl;
             cout.precision(p);
         }
@@ -447,7 +1077,15 @@ static int inner_main(int argc, char **argv)
             int p = cout.precision();
 
             header.fill('-');
-            header << left << setw(79) << "--- Suffix Array Stats ";
+            if (NULL != local_data->minimizers) {
+                header << left << setw(79) << "--- Minimizer Filter Stats ";
+            }
+            else if (NULL != local_data->fm_index) {
+                header << left << setw(79) << "--- FM-Index Filter Stats ";
+            }
+            else {
+                header << left << setw(79) << "--- Suffix Array Stats ";
+            }
             cout << header.str() << endl;
             cout << setprecision(2);
             Stats::width(13);
@@ -472,6 +1110,13 @@ static int inner_main(int argc, char **argv)
             cout << "first array" << setw(25) << cumulative.time_first << endl;
             cout << " last array" << setw(25) << cumulative.time_last << endl;
             cout << "       diff" << setw(25) << cumulative.time_last - cumulative.time_first << endl;
+            /* one line to compare engines run on the same input */
+            cout << "filter " << parameters->filter_engine
+                << ": generated " << (unsigned long)cumulative.pairs.sum()
+                << " unique " << (unsigned long)cumulative.unique.sum()
+                << " seconds " << cumulative.time_build.sum()
+                                + cumulative.time_process.sum()
+                << endl;
             cout.precision(p);
             cout << string(79, '-') << endl;
         }
@@ -489,8 +1134,31 @@ static int inner_main(int argc, char **argv)
     delete parameters;
     free(packed_buffer);
     delete [] SID;
+    delete local_data->workspace;
+    for (size_t q=0; q<local_data->profiles.size(); ++q) {
+        if (NULL != local_data->profiles[q].profile) {
+            parasail_profile_free(local_data->profiles[q].profile);
+        }
+        if (NULL != local_data->screen_profiles[q].profile) {
+            parasail_profile_free(local_data->screen_profiles[q].profile);
+        }
+    }
+    delete local_data->minimizers;
+    delete local_data->fm_index;
     delete local_data;
 
+    {
+        struct rusage usage;
+        long rss = 0;
+        if (0 == getrusage(RUSAGE_SELF, &usage)) {
+            rss = usage.ru_maxrss;
+        }
+        mpix::reduce(rss, MPI_MAX, 0, pgraph::comm);
+        if (0 == rank) {
+            cout << "peak rss " << rss << " KiB" << endl;
+        }
+    }
+
     time_main = MPI_Wtime() - time_main;
     if (0 == rank) {
         cout << "time_main " << time_main << " seconds" << endl;
@@ -500,245 +1168,390 @@ static int inner_main(int argc, char **argv)
     return 0;
 }
 
-static void pair_check(
-        unsigned long &count_generated,
-        PairSet &pairs,
-        const int &i,
-        const int &j,
-        const int * const restrict SA,
-        const unsigned char * const restrict BWT,
-        const int * const restrict SID,
-        int sid_crossover,
-        const char &sentinal)
-{
-    const int &sidi = SID[SA[i]];
-    const int &sidj = SID[SA[j]];
-    if (BWT[i] != BWT[j] || BWT[i] == sentinal) {
-        if (0 == sid_crossover) {
-            if (sidi != sidj) {
-                ++count_generated;
-                if (sidi < sidj) {
-                    pairs.insert(make_pair(sidi,sidj));
-                }
-                else {
-                    pairs.insert(make_pair(sidj,sidi));
-                }
-            }
-        }
-        else {
-            if ((sidi < sid_crossover && sidj >= sid_crossover)
-                    || (sidj < sid_crossover && sidi >= sid_crossover)) {
-                ++count_generated;
-                if (sidi < sidj) {
-                    pairs.insert(make_pair(sidi,sidj));
-                }
-                else {
-                    pairs.insert(make_pair(sidj,sidi));
-                }
-            }
+/* Deduplicates pairs against the tile's seen bitmap and queues what is
+ * new, or aligns it right away if the queue is full. Leaves pairs empty. */
+static void stream_batch(PairStream *stream, PairVec &pairs)
+{
+    size_t count = 0;
+
+    radix_sort_unique(pairs);
+    for (size_t k=0; k<pairs.size(); ++k) {
+        uint64_t bit = (pair_first(pairs[k]) - stream->first_beg)
+                * stream->second_count
+                + (pair_second(pairs[k]) - stream->second_beg);
+        uint64_t mask = uint64_t(1) << (bit & 63);
+        uint64_t old;
+#pragma omp atomic capture
+        { old = stream->seen[bit >> 6]; stream->seen[bit >> 6] |= mask; }
+        if (!(old & mask)) {
+            pairs[count++] = pairs[k];
         }
     }
+    pairs.resize(count);
+#pragma omp atomic
+    stream->unique += count;
+
+    if (!pairs.empty() && !stream->queue->push(pairs)) {
+#pragma omp atomic
+        stream->full += 1;
+        align_batch(stream->local_data, pairs);
+    }
+    pairs.clear();
 }
 
-/* try to reduce number of duplicate pairs generated */
-/* we observe that l-intervals (i.e. internal nodes) always have at
- * least two children, but these children could be singleton
- * l-intervals, e.g., [i..j]=[1..1], in addition to l-intervals with
- * non-singleton ranges/quads. For each l-interval, we take the cross
- * product of its child l-intervals. Naively, we could take the cross
- * product of the entire lb/rb range of the l-interval, but this
- * generates too many duplicate pairs. Instead, the complexity should be
- * bounded by the number of exact matches...
- */
-static void process(
-        unsigned long &count_generated,
-        PairSet &pairs,
-        const quad &q,
-        const int * const restrict SA,
-        const unsigned char * const restrict BWT,
-        const int * const restrict SID,
-        int sid_crossover,
-        const char &sentinal,
-        const int &cutoff)
-{
-    const int n_children = q.children.size();
-    int child_index = 0;
-
-    if (q.lcp < cutoff) return;
-
-    if (n_children) {
-        for (int i=q.lb; i<=q.rb; ++i) {
-            int j = i+1;
-            if (child_index < n_children) {
-                if (i >= q.children[child_index].lb) {
-                    j = q.children[child_index].rb+1;
-                    if (i >= q.children[child_index].rb) {
-                        ++child_index;
-                    }
-                }
-            }
-            for (/*nope*/; j<=q.rb; ++j) {
-                pair_check(count_generated, pairs, i, j, SA, BWT, SID, sid_crossover, sentinal);
-            }
-        }
+void PairStream::added(PairVec &pairs)
+{
+    if (pairs.size() >= batch) {
+        stream_batch(this, pairs);
     }
-    else {
-        for (int i=q.lb; i<=q.rb; ++i) {
-            for (int j=i+1; j<=q.rb; ++j) {
-                pair_check(count_generated, pairs, i, j, SA, BWT, SID, sid_crossover, sentinal);
-            }
-        }
+}
+
+void PairStream::finished(PairVec &pairs)
+{
+    stream_batch(this, pairs);
+}
+
+/* aligns the pairs on the calling thread */
+static void align_batch(local_data_t *local_data, const PairVec &pairs)
+{
+    int thd = omp_get_thread_num();
+    for (size_t k=0; k<pairs.size(); ++k) {
+        alignment_task(pair_first(pairs[k]), pair_second(pairs[k]), local_data, thd);
     }
 }
 
-/* SID and T arrays are of size n. */
-static void SA_filter(
+/* The tile is read in place from the packed sequences; see TileView. */
+static double SA_filter(
         local_data_t *local_data,
-        int *SID,
-        const char *T,
-        long n,
-        char sentinal,
+        const TileView &view,
         int sid_crossover,
         int cutoff,
-        SuffixArrayStats &stats_sa)
+        size_t id1,
+        size_t id2,
+        SuffixArrayStats &stats_sa,
+        PairVec &vpairs,
+        bool stream,
+        int step)
 {
     int rank = mpix::comm_rank(pgraph::comm);
     int nprocs = mpix::comm_size(pgraph::comm);
-    int *SID_local = NULL;
-    int *SA = NULL;
+    char sentinal = local_data->sentinal;
+    long n = view.n();
+    long m = n; /* suffixes indexed */
+    long len1 = view.len[0];
+    int *SID_SA = NULL;
     int *LCP = NULL;
     unsigned char *BWT = NULL;
-    int i = 0;
+    char first = 0;
+    char last = 0;
+    double bytes = 0.0;
+    bool wide = n >= min((long)local_data->parameters->sa_wide_residues,
+                         (long)INT_MAX);
+    bool sparse = step > 1 && id1 != id2;
+    bool sample_first = false;
+    const BlockESA<int> *esa1 = NULL;
+    const BlockESA<int> *esa2 = NULL;
+    const int *SA_narrow = NULL;
+    const long *SA_wide = NULL;
+    long heavy = local_data->parameters->heavy_interval_width;
     long sid = 0;
-    vector<long> BEG;
-    vector<long> END;
-    double time = 0.0;
     unsigned long count_possible = 0;
-    unsigned long count_generated = 0;
+    PairCounts counts;
+    unsigned long count_unique = 0;
     int sid_crossover_local = 0;
-    PairSet pairs;
-    PairVec vpairs;
     double time_build = 0.0;
     double time_process = 0.0;
+    double time_stream = 0.0;
+    size_t first_beg;
+    size_t second_beg;
+    size_t second_end;
 
     if (stats_sa.time_first == 0.0) {
         stats_sa.time_first = MPI_Wtime();
     }
 
     time_build = MPI_Wtime();
-    time = MPI_Wtime();
-    SID_local = new int[n+1];
-    /* scan T from left to build sequence ID and end index */
-    sid = 0;
-    BEG.push_back(0);
-    for (long i=0; i<n; ++i) {
-        SID_local[i] = sid;
-        if (T[i] == sentinal) {
-            END.push_back(i);
-            BEG.push_back(i+1);
-            if (0 == sid_crossover_local && SID[i] == sid_crossover) {
-                sid_crossover_local = sid;
-            }
-            ++sid;
+
+    /* the tile's sequences are those of its blocks, no need to scan T */
+    {
+        size_t seq_end;
+        block_range(local_data, id1, first_beg, seq_end);
+        sid = seq_end - first_beg + 1;
+        second_beg = first_beg;
+        second_end = seq_end;
+        if (id1 != id2) {
+            sid_crossover_local = sid;
+            block_range(local_data, id2, second_beg, second_end);
+            sid += second_end - second_beg + 1;
         }
     }
-    assert(0 != sid);
-    BEG.pop_back();
-    assert(BEG.size() == END.size());
-    time = MPI_Wtime() - time;
-#if 0
-    if (0 == rank) {
-        cout << "number of local sequences: " << sid << endl;;
-        cout << "time index local db " << time << endl;
+
+    /* Sample the larger block of a sparse tile. A match of cutoff residues
+     * between the blocks then starts at a sampled suffix within step-1
+     * residues of its start, and the suffix of the other block at the same
+     * offset is indexed, so the two share at least cutoff-step+1 residues.
+     * Sampled suffixes lose their left neighbours and so all count as left
+     * maximal. The suffix and LCP arrays are merged from those of the two
+     * blocks, and only the sampled suffixes of the larger one are sorted. */
+    if (sparse) {
+        sample_first = len1 >= view.len[1];
+        if (wide) {
+            long *SA = NULL;
+            m = sparse_esa(local_data, view, id1, id2, step, sample_first, SA, LCP, bytes);
+            SA_wide = SA;
+        }
+        else {
+            int *SA = NULL;
+            m = sparse_esa(local_data, view, id1, id2, step, sample_first, SA, LCP, bytes);
+            SA_narrow = SA;
+        }
+        bytes /= n;
+    }
+    else {
+        LCP = local_data->workspace->get<int>(WS_LCP, n+1); /* +1 for lcp tree */
     }
-#endif
 
-    /* Allocate memory for enhanced SA. */
-    SA = new int[n+1]; /* +1 for LCP */
-    LCP = new int[n+1]; /* +1 for lcp tree */
-    BWT = new unsigned char[n+1];
-    if((SA == NULL) || (LCP == NULL) || (BWT == NULL))
+    /* Allocate memory for enhanced SA. The traversal reads only the
+     * clamped LCPs, BWT and sequence ids, which are the same whatever the
+     * width of the suffix array indices. */
+    BWT = local_data->workspace->get<unsigned char>(WS_BWT, m+1);
+    SID_SA = local_data->workspace->get<int>(WS_SID_SA, m+1);
+    if((LCP == NULL) || (BWT == NULL) || (SID_SA == NULL))
     {
         cerr << "Cannot allocate ESA memory." << endl;
         exit(EXIT_FAILURE);
     }
 
-    /* Construct the suffix and LCP arrays.
-     * The following sais routine is from Fischer, with bugs fixed. */
-    if(sais((const unsigned char *)T, SA, LCP, (int)n) != 0) {
-        cerr << "Cannot allocate memory." << endl;
-        exit(EXIT_FAILURE);
+    /* Finish the merged arrays of a sparse tile, or construct the suffix
+     * and LCP arrays of a full one, either directly or from the cached
+     * arrays of its blocks. Full tiles too long for int indices are always
+     * built directly, with 64-bit ones. */
+    if (sparse) {
+        if (wide) {
+            finish_esa(local_data, view, m, SA_wide, LCP, LCP, BWT, SID_SA, first, last);
+        }
+        else {
+            finish_esa(local_data, view, m, SA_narrow, LCP, LCP, BWT, SID_SA, first, last);
+        }
+#pragma omp parallel for schedule(static)
+        for (long i = 0; i < m; ++i) {
+            long p = wide ? SA_wide[i] : SA_narrow[i];
+            if ((p < len1) == sample_first) {
+                BWT[i] = sentinal;
+            }
+        }
+        cutoff = cutoff - step + 1;
+        stats_sa.sparse++;
+        if (wide) {
+            stats_sa.wide++;
+        }
     }
-
-    /* construct naive BWT: */
-    for (i = 0; i < n; ++i) {
-        BWT[i] = (SA[i] > 0) ? T[SA[i]-1] : sentinal;
+    else if (wide) {
+        long *SA = local_data->workspace->get<long>(WS_SA, n);
+        long *LCP_wide = local_data->workspace->get<long>(WS_LCP_WIDE, n);
+        SA_wide = SA;
+        build_esa(local_data, view, SA, LCP_wide);
+        finish_esa(local_data, view, n, SA, LCP_wide, LCP, BWT, SID_SA, first, last);
+        bytes = ESA_BYTES_WIDE;
+        stats_sa.wide++;
     }
-
-    /* "fix" the LCP array to clamp LCP's that are too long */
-    for (i = 0; i < n; ++i) {
-        int len = END[SID_local[SA[i]]] - SA[i]; /* don't include sentinal */
-        if (LCP[i] > len) LCP[i] = len;
+    else {
+        int *SA = local_data->workspace->get<int>(WS_SA, n+1); /* +1 for LCP */
+        SA_narrow = SA;
+        bytes = ESA_BYTES_NARROW;
+        if (local_data->parameters->sa_block_cache > 0) {
+            /* both block ESAs are held while merging, and the rank array
+             * of a block sorted on a miss is at most the tile's */
+            bytes += 2*sizeof(int);
+            esa1 = get_block_esa(local_data, id1, view.segment(0), len1);
+            if (id1 == id2) {
+                copy(esa1->SA.begin(), esa1->SA.end(), SA);
+                copy(esa1->LCP.begin(), esa1->LCP.end(), LCP);
+            }
+            else {
+                esa2 = get_block_esa(local_data, id2, view.segment(1), view.len[1]);
+                merge_esa(view.segment(0), *esa1, view.segment(1), *esa2, sentinal, len1, SA, LCP);
+            }
+        }
+        else {
+            build_esa(local_data, view, SA, LCP);
+            if (0 == view.len[1] && !(local_data->parameters->sa_parallel
+                        && !omp_in_parallel())) {
+                bytes -= ESA_SCRATCH_NARROW; /* sorted by sais */
+            }
+        }
+        finish_esa(local_data, view, n, SA, LCP, LCP, BWT, SID_SA, first, last);
     }
 
     stats_sa.time_build.push_back(MPI_Wtime() - time_build);
+    stats_sa.bytes.push_back(bytes);
     time_process = MPI_Wtime();
 
     /* The GSA we create will put all sentinals either at the beginning
      * or end of the SA. We don't want to count all of the terminals,
      * nor do we want to process them in our bottom-up traversal. */
     /* do the sentinals appear at the beginning or end of SA? */
-    int bup_start = 1;
-    int bup_stop = n;
-    if (T[SA[0]] == sentinal) {
+    long bup_start = 1;
+    long bup_stop = m;
+    if (first == sentinal) {
         /* sentinals at beginning */
         bup_start = sid+1;
-        bup_stop = n;
+        bup_stop = m;
     }
-    else if (T[SA[n-1]] == sentinal) {
+    else if (last == sentinal) {
         /* sentinals at end */
         bup_start = 1;
-        bup_stop = n-sid;
+        bup_stop = m-sid;
     }
     else {
         cerr << "sentinals not found at beginning or end of SA" << endl;
         exit(EXIT_FAILURE);
     }
 
-    /* DFS of enhanced SA, from Abouelhoda et al */
-    count_generated = 0;
-    LCP[n] = 0; /* doesn't really exist, but for the root */
+    /* Streaming replaces the pair buffers by a bitmap of the tile's
+     * possible pairs, so only when that is no larger than what the buffers
+     * may hold anyway. Inside the pipelined loop the threads are busy. */
+    if (stream) {
+        double bits = double(sid - sid_crossover_local)
+            * (sid_crossover_local > 0 ? sid_crossover_local : sid);
+        double limit = max(double(n*sizeof(int)),
+                double(PAIR_COMPACT_SIZE*sizeof(uint64_t)));
+        stream = !omp_in_parallel() && bits/8 <= limit;
+    }
+
+    /* DFS of enhanced SA, from Abouelhoda et al.
+     * Every l-interval with l >= cutoff lies strictly between two
+     * positions whose LCP is below the cutoff, so the SA is cut into
+     * chunks at such positions and the chunks are traversed concurrently.
+     * Chunks are oversubscribed since repetitive families make a few of
+     * them much deeper than the rest. Inside the pipelined loop we are
+     * already in a parallel region and this runs as a single chunk. */
+    LCP[m] = 0; /* doesn't really exist, but for the root */
     {
-        stack<quad> the_stack;
-        quad last_interval;
-        the_stack.push(quad());
-        for (i = bup_start; i <= bup_stop; ++i) {
-            int lb = i - 1;
-            while (LCP[i] < the_stack.top().lcp) {
-                the_stack.top().rb = i - 1;
-                last_interval = the_stack.top();
-                the_stack.pop();
-                process(count_generated, pairs, last_interval, SA, BWT, SID, sid_crossover, sentinal, cutoff);
-                lb = last_interval.lb;
-                if (LCP[i] <= the_stack.top().lcp) {
-                    last_interval.children.clear();
-                    the_stack.top().children.push_back(last_interval);
-                    last_interval = quad();
-                }
-            }
-            if (LCP[i] > the_stack.top().lcp) {
-                if (!last_interval.empty()) {
-                    last_interval.children.clear();
-                    the_stack.push(quad(LCP[i],lb,INT_MAX,vector<quad>(1, last_interval)));
-                    last_interval = quad();
-                }
-                else {
-                    the_stack.push(quad(LCP[i],lb,INT_MAX));
-                }
+        int n_chunks = omp_in_parallel() ? 1 : ESA_CHUNKS_PER_WORKER*omp_get_max_threads();
+        vector<long> chunk_start(n_chunks+1, bup_stop);
+        vector<PairVec> chunk_pairs(n_chunks);
+        vector<size_t> chunk_offset(n_chunks+1, 0);
+        vector<PairCounts> chunk_counts(n_chunks);
+        long span = bup_stop - bup_start;
+
+        chunk_start[0] = bup_start;
+        for (int c = 1; c < n_chunks; ++c) {
+            long k = bup_start + span * c / n_chunks;
+            k = max(k, chunk_start[c-1]);
+            while (k < bup_stop && LCP[k] >= cutoff) {
+                ++k;
             }
+            chunk_start[c] = k;
+        }
+
+        if (stream) {
+            /* Threads align queued batches first and traverse the next
+             * chunk only when the queue is empty, so at most the queue
+             * and one batch per thread of pairs are held at a time. */
+            Parameters *parameters = local_data->parameters;
+            size_t first_count = sid_crossover_local > 0 ?
+                sid_crossover_local : sid;
+            size_t words = 0;
+            PairQueue queue(parameters->pair_queue_depth > 0 ?
+                    parameters->pair_queue_depth : 4*omp_get_max_threads());
+            PairStream ps;
+            long long next_chunk = 0;
+            double time_stall = 0.0;
+
+            words = (first_count*(second_end-second_beg+1) + 63) / 64;
+            ps.local_data = local_data;
+            ps.queue = &queue;
+            ps.seen = local_data->workspace->get<uint64_t>(WS_SEEN, words);
+            ps.first_beg = first_beg;
+            ps.second_beg = second_beg;
+            ps.second_count = second_end - second_beg + 1;
+            ps.batch = max(parameters->pair_batch_size, 1);
+            ps.unique = 0;
+            ps.full = 0;
+            fill(ps.seen, ps.seen + words, uint64_t(0));
+            time_stream = MPI_Wtime();
+
+#pragma omp parallel reduction(+:time_stall)
+            {
+                PairVec batch;
+                double t;
+                while (true) {
+                    long long c;
+                    if (queue.pop(batch)) {
+                        align_batch(local_data, batch);
+                        batch.clear();
+                        continue;
+                    }
+                    queue.open();
+#pragma omp atomic capture
+                    c = next_chunk++;
+                    if (c < n_chunks) {
+                        if (chunk_start[c] < chunk_start[c+1]) {
+                            lcp_intervals(chunk_counts[c], batch,
+                                    chunk_start[c], chunk_start[c+1],
+                                    LCP, BWT, SID_SA, sid_crossover,
+                                    sentinal, cutoff, heavy, ps);
+                        }
+                        queue.close();
+                        continue;
+                    }
+                    queue.close();
+                    if (queue.drained()) {
+                        break;
+                    }
+                    t = MPI_Wtime();
+                    usleep(PAIR_STREAM_BACKOFF);
+                    time_stall += MPI_Wtime() - t;
+                }
+                t = MPI_Wtime();
+#pragma omp barrier
+                time_stall += MPI_Wtime() - t;
+            }
+
+            time_stream = MPI_Wtime() - time_stream;
+            for (int c = 0; c < n_chunks; ++c) {
+                counts += chunk_counts[c];
+            }
+            count_unique = ps.unique;
+            vpairs.clear();
+            stats_sa.queue.push_back(queue.depth());
+            stats_sa.time_stall.push_back(time_stall);
+            stats_sa.full += ps.full;
+            (*local_data->debug_out) << "stream time: " << time_stream
+                << "\tqueue " << queue.depth()
+                << "\tfull " << ps.full
+                << "\tstall " << time_stall
+                << endl;
+        }
+        else {
+#pragma omp parallel for schedule(dynamic) if (n_chunks > 1)
+            for (int c = 0; c < n_chunks; ++c) {
+                if (chunk_start[c] < chunk_start[c+1]) {
+                    PairCompactor compactor(local_data->pair_compact);
+                    lcp_intervals(chunk_counts[c], chunk_pairs[c],
+                            chunk_start[c], chunk_start[c+1],
+                            LCP, BWT, SID_SA, sid_crossover, sentinal, cutoff,
+                            heavy, compactor);
+                }
+            }
+
+            for (int c = 0; c < n_chunks; ++c) {
+                counts += chunk_counts[c];
+                chunk_offset[c+1] = chunk_offset[c] + chunk_pairs[c].size();
+            }
+
+            /* gather the chunk buffers, then sort and deduplicate them */
+            vpairs.resize(chunk_offset[n_chunks]);
+#pragma omp parallel for schedule(dynamic) if (n_chunks > 1)
+            for (int c = 0; c < n_chunks; ++c) {
+                copy(chunk_pairs[c].begin(), chunk_pairs[c].end(),
+                        vpairs.begin() + chunk_offset[c]);
+                PairVec().swap(chunk_pairs[c]);
+            }
+            radix_sort_unique(vpairs);
+            count_unique = vpairs.size();
         }
-        the_stack.top().rb = bup_stop - 1;
-        process(count_generated, pairs, the_stack.top(), SA, BWT, SID, sid_crossover, sentinal, cutoff);
     }
     stats_sa.time_process.push_back(MPI_Wtime() - time_process);
     if (0 == sid_crossover) {
@@ -750,59 +1563,417 @@ static void SA_filter(
 #if 1
     (*local_data->debug_out) << "ESA time: " << MPI_Wtime() - time_process << endl;
     //(*local_data->debug_out) << "possible pairs: " << count_possible << endl;
-    (*local_data->debug_out) << "generated pairs: " << count_generated << endl;
-    (*local_data->debug_out) << "unique pairs: " << pairs.size() << endl;
+    (*local_data->debug_out) << "generated pairs: " << counts.generated << endl;
+    if (!local_data->mask.empty()) {
+        (*local_data->debug_out) << "masked pairs: " << counts.masked << endl;
+    }
+    if (heavy > 0) {
+        /* name the k-mers behind the widest guarded intervals */
+        size_t report = min(counts.heavy.size(), (size_t)HEAVY_INTERVAL_REPORT);
+        partial_sort(counts.heavy.begin(), counts.heavy.begin() + report,
+                counts.heavy.end());
+        (*local_data->debug_out) << "heavy intervals: " << counts.heavy.size() << endl;
+        for (size_t h=0; h<report; ++h) {
+            const heavy_interval &hi = counts.heavy[h];
+            long start = SA_wide ? SA_wide[hi.lb] : SA_narrow[hi.lb];
+            string kmer;
+            for (int k=0; k<min(hi.lcp, cutoff); ++k) {
+                kmer += view.at(start + k);
+            }
+            (*local_data->debug_out) << "heavy interval: " << kmer
+                << "\tlcp " << hi.lcp
+                << "\twidth " << hi.width
+                << "\tsequences " << hi.sids
+                << endl;
+        }
+    }
+    (*local_data->debug_out) << "unique pairs: " << count_unique << endl;
 #endif
 
     stats_sa.arrays++;
-    stats_sa.suffixes.push_back(n);
-    stats_sa.pairs.push_back(count_generated);
+    stats_sa.suffixes.push_back(m);
+    stats_sa.pairs.push_back(counts.generated);
+    stats_sa.unique.push_back(count_unique);
+    if (!local_data->mask.empty()) {
+        stats_sa.masked.push_back(counts.masked);
+    }
+    if (heavy > 0) {
+        stats_sa.heavy.push_back(counts.heavy.size());
+    }
     stats_sa.time_last = MPI_Wtime();
 
-    /* OpenMP can't iterate over an STL set. Convert to STL vector. */
-    vpairs.assign(pairs.begin(), pairs.end());
-    pairs.clear();
+    return time_stream;
+}
 
-    vector<EdgeResult> *edge_results = local_data->edge_results;
+/* Construct the suffix and LCP arrays.
+ * The following sais routine is from Fischer, with bugs fixed.
+ * sais_omp produces the same arrays using the OpenMP threads, but only
+ * when not already inside a parallel region (see pipelined_tasks). */
+static void build_esa(
+        local_data_t *local_data,
+        const char *T,
+        long n,
+        int *SA,
+        int *LCP)
+{
+    if (local_data->parameters->sa_parallel && !omp_in_parallel()) {
+        if (pgraph::sais_omp((const unsigned char *)T, SA, LCP, (int)n) != 0) {
+            cerr << "Cannot allocate memory." << endl;
+            exit(EXIT_FAILURE);
+        }
+    }
+    else if(sais((const unsigned char *)T, SA, LCP, (int)n) != 0) {
+        cerr << "Cannot allocate memory." << endl;
+        exit(EXIT_FAILURE);
+    }
+}
 
-    if (local_data->parameters->output_to_disk) {
-        for (int worker=0; worker<NUM_WORKERS; ++worker) {
-            edge_results[worker].clear();
+/* sais has no 64-bit variant, so these tiles always go to sais_omp */
+static void build_esa(
+        local_data_t *,
+        const char *T,
+        long n,
+        long *SA,
+        long *LCP)
+{
+    if (pgraph::sais_omp((const unsigned char *)T, SA, LCP, n) != 0) {
+        cerr << "Cannot allocate memory." << endl;
+        exit(EXIT_FAILURE);
+    }
+}
+
+/* The tile where it lies in the packed sequences. A diagonal tile is one
+ * string; sais needs one, so an off-diagonal tile is sorted by sais_omp
+ * through the view, on one thread unless SuffixArrayParallel. */
+template <class Index>
+static void build_esa(
+        local_data_t *local_data,
+        const TileView &view,
+        Index *SA,
+        Index *LCP)
+{
+    int threads = local_data->parameters->sa_parallel ? 0 : 1;
+
+    if (0 == view.len[1]) {
+        build_esa(local_data, view.segment(0), view.n(), SA, LCP);
+    }
+    else if (pgraph::sais_omp(TileText(view), SA, LCP, Index(view.n()),
+                threads) != 0) {
+        cerr << "Cannot allocate memory." << endl;
+        exit(EXIT_FAILURE);
+    }
+}
+
+/* Derives what the traversal reads from the tile's suffix array of n
+ * suffixes: the naive BWT, the sequence id of every suffix in SA order,
+ * and the LCPs "fixed" to stop at each suffix's sentinal, which always fit
+ * an int. LCP may be LCP_built. first and last are the leading characters
+ * of the first and last suffix. */
+template <class Index, class Built>
+static void finish_esa(
+        local_data_t *local_data,
+        const TileView &view,
+        long n,
+        const Index *SA,
+        const Built *LCP_built,
+        int *LCP,
+        unsigned char *BWT,
+        int *SID_SA,
+        char &first,
+        char &last)
+{
+    const vector<long> &END = *(local_data->END);
+    const vector<uint64_t> &mask = local_data->mask;
+    const int *SID = local_data->SID;
+    char sentinal = local_data->sentinal;
+
+#pragma omp parallel for schedule(static)
+    for (long i = 0; i < n; ++i) {
+        long g = view.global(SA[i]);
+        long len = END[SID[g]] - g; /* don't include sentinal */
+        BWT[i] = (SA[i] > 0) ? view.at(SA[i]-1) : sentinal;
+        SID_SA[i] = SID[g];
+        LCP[i] = (LCP_built[i] > len) ? len : LCP_built[i];
+        /* a match can't be extended left into a masked region, so the
+         * suffix after one is left maximal */
+        if (!mask.empty()) {
+            if (is_masked(mask, g)) {
+                SID_SA[i] = ~SID[g];
+            }
+            if (SA[i] > 0 && is_masked(mask, view.global(SA[i]-1))) {
+                BWT[i] = sentinal;
+            }
         }
     }
+    first = view.at(SA[0]);
+    last = view.at(SA[n-1]);
+}
 
-    time_process = MPI_Wtime();
-    /* align pairs */
-#pragma omp parallel
-    {
-        int thd = omp_get_thread_num();
-#pragma omp for schedule(guided)
-        for (long long index=0; index<(long long)vpairs.size(); ++index) {
-            int i = vpairs[index].first;
-            int j = vpairs[index].second;
-            //cout << "alignment_task("<<i<<", "<<j<<", local_data, "<<thd<<");"<<endl;
-            alignment_task(i, j, local_data, thd);
+/* Builds the ESA of a block whose text T of length n ends with a sentinal,
+ * with the LCPs clamped to the end of each suffix's own sequence, which is
+ * the only form merge_esa can extend across blocks. */
+template <class Index>
+static void build_block_esa(
+        local_data_t *local_data,
+        const char *T,
+        long n,
+        BlockESA<Index> &esa)
+{
+    esa.SA.resize(n+1); /* sais uses the extra entry, as in SA_filter */
+    esa.LCP.resize(n+1);
+    build_esa(local_data, T, n, &esa.SA[0], &esa.LCP[0]);
+    esa.SA.resize(n);
+    esa.LCP.resize(n);
+
+    vector<Index> end(n);
+    long last = n-1;
+    for (long i=n-1; i>=0; --i) {
+        if (T[i] == local_data->sentinal) {
+            last = i;
         }
+        end[i] = last;
     }
-    time_process = MPI_Wtime() - time_process;
-    (*local_data->debug_out) << "align time: " << time_process << endl;
-    (*local_data->debug_out) << "time per align: " << time_process/vpairs.size() << endl;
+    for (long i=0; i<n; ++i) {
+        Index len = end[esa.SA[i]] - esa.SA[i]; /* don't include sentinal */
+        if (esa.LCP[i] > len) esa.LCP[i] = len;
+    }
+}
 
-    if (local_data->parameters->output_to_disk) {
-        for (int worker=0; worker<NUM_WORKERS; ++worker) {
-            size_t limit = edge_results[worker].size();
-            for (size_t i=0; i<limit; ++i) {
-                (*local_data->edge_out) << edge_results[worker][i] << endl;
+/* Returns the ESA of the given block, whose text T of length n must end
+ * with a sentinal, building it on a miss. At most SuffixArrayBlockCache
+ * blocks, but never fewer than the two of a tile, are kept. */
+static const BlockESA<int>* get_block_esa(
+        local_data_t *local_data,
+        size_t block,
+        const char *T,
+        long n)
+{
+    list<BlockESA<int> > &cache = local_data->block_esa;
+    size_t capacity = max(2, local_data->parameters->sa_block_cache);
+
+    for (list<BlockESA<int> >::iterator it=cache.begin(); it!=cache.end(); ++it) {
+        if (it->block == block) {
+            cache.splice(cache.begin(), cache, it);
+            (*local_data->debug_out) << "block " << block << " ESA reused" << endl;
+            return &cache.front();
+        }
+    }
+
+    if (cache.size() >= capacity) {
+        cache.pop_back();
+    }
+    cache.push_front(BlockESA<int>());
+    BlockESA<int> &esa = cache.front();
+    esa.block = block;
+    build_block_esa(local_data, T, n, esa);
+
+    (*local_data->debug_out) << "block " << block << " ESA built" << endl;
+    return &esa;
+}
+
+/* The full ESA of the unsampled block of a sparse tile: the cached one
+ * when SuffixArrayBlockCache is set, otherwise built into esa for this
+ * tile only. 64-bit ones are never cached. */
+static const BlockESA<int>* other_block_esa(
+        local_data_t *local_data,
+        size_t block,
+        const char *T,
+        long n,
+        BlockESA<int> &esa)
+{
+    if (local_data->parameters->sa_block_cache > 0) {
+        return get_block_esa(local_data, block, T, n);
+    }
+    build_block_esa(local_data, T, n, esa);
+    return &esa;
+}
+
+static const BlockESA<long>* other_block_esa(
+        local_data_t *local_data,
+        size_t block,
+        const char *T,
+        long n,
+        BlockESA<long> &esa)
+{
+    build_block_esa(local_data, T, n, esa);
+    return &esa;
+}
+
+/* Merges the ESAs of two blocks into the ESA of their concatenation T1T2,
+ * where T1 has n1 characters. Either ESA may hold only some suffixes.
+ * Suffixes compare only up to their sentinal, the same comparison the
+ * clamped LCPs express, and ties go to the first block. ha and hb are the
+ * LCPs of the two heads with the suffix last written, so the block LCPs
+ * decide most steps and characters are only compared past the longer of
+ * the two known prefixes. */
+template <class Index>
+static void merge_esa(
+        const char *T1,
+        const BlockESA<Index> &esa1,
+        const char *T2,
+        const BlockESA<Index> &esa2,
+        char sentinal,
+        long n1,
+        Index *SA,
+        int *LCP)
+{
+    const unsigned char *U1 = (const unsigned char *)T1;
+    const unsigned char *U2 = (const unsigned char *)T2;
+    const unsigned char end = (unsigned char)sentinal;
+    const long m1 = esa1.SA.size();
+    const long m2 = esa2.SA.size();
+    long a = 0;
+    long b = 0;
+    int ha = 0;
+    int hb = 0;
+    long k = 0;
+
+    while (a < m1 && b < m2) {
+        bool take_a = false;
+        if (ha != hb) {
+            take_a = ha > hb;
+        }
+        else {
+            const unsigned char *p = &U1[esa1.SA[a]];
+            const unsigned char *q = &U2[esa2.SA[b]];
+            int l = ha;
+            while (p[l] == q[l] && p[l] != end) {
+                ++l;
+            }
+            take_a = p[l] <= q[l];
+            /* the head not taken has LCP l with the one about to be written */
+            if (take_a) {
+                hb = l;
+            }
+            else {
+                ha = l;
             }
         }
-        local_data->edge_out->flush();
+        if (take_a) {
+            SA[k] = esa1.SA[a];
+            LCP[k++] = ha;
+            ha = (++a < m1) ? esa1.LCP[a] : 0;
+        }
+        else {
+            SA[k] = n1 + esa2.SA[b];
+            LCP[k++] = hb;
+            hb = (++b < m2) ? esa2.LCP[b] : 0;
+        }
+    }
+    while (a < m1) {
+        SA[k] = esa1.SA[a];
+        LCP[k++] = ha;
+        ha = (++a < m1) ? esa1.LCP[a] : 0;
+    }
+    while (b < m2) {
+        SA[k] = n1 + esa2.SA[b];
+        LCP[k++] = hb;
+        hb = (++b < m2) ? esa2.LCP[b] : 0;
+    }
+}
+
+/* The ESA of the suffixes of a block that start a multiple of step residues
+ * into their sequence, and of all its sentinals, sorted without the rest of
+ * the block. beg is the block's first position in the packed sequences and
+ * n its length. The LCPs are clamped like those of build_block_esa. */
+template <class Index>
+static void sample_esa(
+        local_data_t *local_data,
+        long beg,
+        long n,
+        int step,
+        BlockESA<Index> &sampled)
+{
+    const vector<long> &BEG = *(local_data->BEG);
+    const vector<long> &END = *(local_data->END);
+    const int *SID = local_data->SID;
+    const char *T = &local_data->sequences[beg];
+    int threads = local_data->parameters->sa_parallel ? 0 : 1;
+    long m = 0;
+
+    /* blocks hold whole sequences, each followed by its sentinal */
+    sampled.SA.clear();
+    for (long g = beg; g < beg + n; g = END[SID[g]] + 1) {
+        long s = SID[g];
+        for (long o = BEG[s]; o < END[s]; o += step) {
+            sampled.SA.push_back(o - beg);
+        }
+        sampled.SA.push_back(END[s] - beg);
+    }
+    m = sampled.SA.size();
+    sampled.LCP.resize(m);
+
+    if (pgraph::sais_omp_sparse(T, Index(n), &sampled.SA[0],
+                &sampled.LCP[0], Index(m), threads) != 0) {
+        cerr << "Cannot allocate memory." << endl;
+        exit(EXIT_FAILURE);
+    }
+
+#pragma omp parallel for schedule(static)
+    for (long i = 0; i < m; ++i) {
+        long g = beg + sampled.SA[i];
+        Index len = END[SID[g]] - g; /* don't include sentinal */
+        if (sampled.LCP[i] > len) sampled.LCP[i] = len;
+    }
+}
+
+/* Merges the suffix and LCP arrays of a sparse tile into the WS_SA and
+ * WS_LCP slots and returns the number of suffixes. The first block is
+ * sampled if sample_first and otherwise the second; the full ESA of the
+ * other comes from other_block_esa. bytes is set to the tile's peak: while
+ * the other block is sorted, while the blocks are merged, or once the
+ * traversal's arrays replace theirs. */
+template <class Index>
+static long sparse_esa(
+        local_data_t *local_data,
+        const TileView &view,
+        size_t id1,
+        size_t id2,
+        int step,
+        bool sample_first,
+        Index *&SA,
+        int *&LCP,
+        double &bytes)
+{
+    int s = sample_first ? 0 : 1;
+    BlockESA<Index> sampled;
+    BlockESA<Index> built;
+    const BlockESA<Index> *other = NULL;
+    long m = 0;
+
+    sample_esa(local_data, view.beg[s], view.len[s], step, sampled);
+    other = other_block_esa(local_data, sample_first ? id2 : id1,
+            view.segment(1-s), view.len[1-s], built);
+    m = sampled.SA.size() + other->SA.size();
+
+    SA = local_data->workspace->get<Index>(WS_SA, m+1);
+    LCP = local_data->workspace->get<int>(WS_LCP, m+1); /* +1 for lcp tree */
+    if ((SA == NULL) || (LCP == NULL)) {
+        cerr << "Cannot allocate ESA memory." << endl;
+        exit(EXIT_FAILURE);
+    }
+    if (sample_first) {
+        merge_esa(view.segment(0), sampled, view.segment(1), *other,
+                local_data->sentinal, view.len[0], SA, LCP);
+    }
+    else {
+        merge_esa(view.segment(0), *other, view.segment(1), sampled,
+                local_data->sentinal, view.len[0], SA, LCP);
+    }
+
+    {
+        double index = sizeof(Index);
+        double m_sampled = sampled.SA.size();
+        double m_other = other->SA.size();
+        /* the other block's rank array, or the sentinal positions its
+         * LCPs are clamped with, both one index per residue */
+        double sort = 2*index*m_sampled + 3*index*m_other;
+        double merge = 2*index*m + (index + sizeof(int))*m;
+        double traverse = (index + 2*sizeof(int) + sizeof(unsigned char))*m;
+        bytes = max(sort, max(merge, traverse));
     }
 
-    /* Deallocate memory. */
-    delete [] SID_local;
-    delete [] SA;
-    delete [] LCP;
-    delete [] BWT;
+    return m;
 }
 
 static string get_edges_filename(int rank)
@@ -812,6 +1983,54 @@ static string get_edges_filename(int rank)
     return str.str();
 }
 
+/* ScreenFunction, or else Function without stats and using the 8-bit
+ * kernel that moves to 16 bits on saturation, e.g. sw_striped_sat for
+ * sw_stats_striped_16 */
+static string screen_function(const Parameters *parameters)
+{
+    string screen = parameters->screen_function;
+    size_t stats;
+    size_t last;
+
+    if (!screen.empty()) {
+        return screen;
+    }
+    screen = parameters->function;
+    stats = screen.find("_stats");
+    if (string::npos != stats) {
+        screen.erase(stats, 6);
+    }
+    last = screen.rfind('_');
+    if (string::npos != last) {
+        screen = screen.substr(0, last) + "_sat";
+    }
+    return screen;
+}
+
+/* the profile of sequence sid held by one thread, rebuilt only when its
+ * previous pair had another first sequence */
+static const parasail_profile_t* query_profile(
+        QueryProfile &query,
+        parasail_pcreator_t *pcreator,
+        int sid,
+        const char *seq,
+        int len,
+        const parasail_matrix_t *matrix,
+        AlignStats &stats)
+{
+    if (query.sid != sid) {
+        double t = MPI_Wtime();
+        if (NULL != query.profile) {
+            parasail_profile_free(query.profile);
+        }
+        query.profile = pcreator(seq, len, matrix);
+        query.sid = sid;
+        stats.time_profile += MPI_Wtime() - t;
+        ++stats.profiles;
+    }
+    return query.profile;
+}
+
 static string get_debug_filename(int rank)
 {
     ostringstream str;
@@ -828,6 +2047,7 @@ static void alignment_task(
     bool is_edge_answer = false;
     double t = 0;
     double tt = 0;
+    int screen_score = -1; /* optimal score, if the screen found it */
     int sscore;
     size_t max_len;
 
@@ -835,6 +2055,7 @@ static void alignment_task(
     const char *sequences = local_data->sequences;
     vector<long> &BEG = *(local_data->BEG);
     vector<long> &END = *(local_data->END);
+    vector<int> &SELF = *(local_data->SELF);
     vector<EdgeResult> *edge_results = local_data->edge_results;
     parasail_function_t *aligner = local_data->aligner;
     const parasail_matrix_t *matrix = local_data->matrix;
@@ -870,27 +2091,49 @@ static void alignment_task(
         stats[thd].work += s1Len * s2Len;
         ++stats[thd].align_counts;
         t = MPI_Wtime();
-        parasail_result_t *result;
-        result = aligner(
-                c1, s1Len, c2, s2Len, -open, -gap, matrix);
-        is_edge_answer = is_edge(
-                result, c1, s1Len, c2, s2Len, AOL, SIM, OS, sscore, max_len, matrix);
-
-        if (parameters->output_to_disk
-                && (is_edge_answer || parameters->output_all))
-        {
-            edge_results[thd].push_back(
-                    EdgeResult(
-                        i, j,
-                        1.0*result->length/max_len,
-                        1.0*result->matches/result->length,
-                        1.0*result->score/sscore,
-                        is_edge_answer)
-                    );
-        }
-        parasail_result_free(result);
-        if (is_edge_answer) {
-            ++stats[thd].edge_counts;
+        if (NULL != local_data->screen
+                && !passes_screen(local_data, i, j, thd, screen_score)) {
+            ++stats[thd].rejected;
+        }
+        else {
+            parasail_result_t banded;
+            parasail_result_t *result = &banded;
+            if (align_in_band(local_data, i, j, screen_score, banded, thd)) {
+                ++stats[thd].banded;
+            }
+            else if (NULL != local_data->paligner) {
+                result = local_data->paligner(
+                        query_profile(local_data->profiles[thd],
+                            local_data->pcreator, i, c1, s1Len,
+                            matrix, stats[thd]),
+                        c2, s2Len, -open, -gap);
+            }
+            else {
+                result = aligner(
+                        c1, s1Len, c2, s2Len, -open, -gap, matrix);
+            }
+            is_edge_answer = is_edge(
+                    result, s1Len, SELF[i], s2Len, SELF[j],
+                    AOL, SIM, OS, sscore, max_len);
+
+            if (parameters->output_to_disk
+                    && (is_edge_answer || parameters->output_all))
+            {
+                edge_results[thd].push_back(
+                        EdgeResult(
+                            i, j,
+                            1.0*result->length/max_len,
+                            1.0*result->matches/result->length,
+                            1.0*result->score/sscore,
+                            is_edge_answer)
+                        );
+            }
+            if (result != &banded) {
+                parasail_result_free(result);
+            }
+            if (is_edge_answer) {
+                ++stats[thd].edge_counts;
+            }
         }
         t = MPI_Wtime() - t;
         stats[thd].time_align.push_back(t);
@@ -904,44 +2147,190 @@ static void alignment_task(
     stats[thd].time_total += tt;
 }
 
+/* Whether the score-only alignment of the pair leaves it a chance to be
+ * an edge; a saturated score is only a lower bound, so it always does.
+ * score is the optimal score found, or -1 if saturated. */
+static bool passes_screen(
+        local_data_t *local_data,
+        size_t i,
+        size_t j,
+        int thd,
+        int &score)
+{
+    AlignStats &stats = local_data->stats_align[thd];
+    const vector<long> &BEG = *(local_data->BEG);
+    const vector<long> &END = *(local_data->END);
+    const vector<int> &SELF = *(local_data->SELF);
+    const parasail_matrix_t *matrix = local_data->matrix;
+    const Parameters *parameters = local_data->parameters;
+    const char *c1 = &local_data->sequences[BEG[i]];
+    const char *c2 = &local_data->sequences[BEG[j]];
+    int s1Len = END[i] - BEG[i];
+    int s2Len = END[j] - BEG[j];
+    int self = s1Len > s2Len ? SELF[i] : SELF[j];
+    bool passes = false;
+    double t = MPI_Wtime();
+    parasail_result_t *result;
+
+    if (NULL != local_data->pscreen) {
+        result = local_data->pscreen(
+                query_profile(local_data->screen_profiles[thd],
+                    local_data->pscreen_creator, i, c1, s1Len,
+                    matrix, stats),
+                c2, s2Len, -parameters->open, -parameters->gap);
+    }
+    else {
+        result = local_data->screen(c1, s1Len, c2, s2Len,
+                -parameters->open, -parameters->gap, matrix);
+    }
+    passes = result->saturated
+        || (result->score > 0 && result->score * 100 >= parameters->OS * self);
+    score = result->saturated ? -1 : result->score;
+    parasail_result_free(result);
+
+    ++stats.screened;
+    stats.time_screen += MPI_Wtime() - t;
+
+    return passes;
+}
+
+/* Aligns a long pair only near the diagonal of its exact matches. The
+ * banded alignment is kept only if it is an edge scoring the optimal
+ * score the screen found; otherwise the pair is aligned again in full
+ * and counted unbanded. */
+static bool align_in_band(
+        local_data_t *local_data,
+        size_t i,
+        size_t j,
+        int score,
+        parasail_result_t &result,
+        int thd)
+{
+    AlignStats &stats = local_data->stats_align[thd];
+    QuerySeeds &seeds = local_data->seeds[thd];
+    const vector<long> &BEG = *(local_data->BEG);
+    const vector<long> &END = *(local_data->END);
+    const vector<int> &SELF = *(local_data->SELF);
+    const Parameters *parameters = local_data->parameters;
+    const char *c1 = &local_data->sequences[BEG[i]];
+    const char *c2 = &local_data->sequences[BEG[j]];
+    int s1Len = END[i] - BEG[i];
+    int s2Len = END[j] - BEG[j];
+    int band = local_data->band;
+    int k = parameters->exact_match_length;
+    int diagonal = 0;
+    int sscore;
+    size_t max_len;
+
+    if (0 == band || score <= 0
+            || max(s1Len, s2Len) < BAND_MIN_SAVING * (2*band + 1)) {
+        return false;
+    }
+
+    if (seeds.sid != int(i)) {
+        seed_kmers(c1, s1Len, k, seeds.workspace);
+        seeds.sid = i;
+    }
+    memset(&result, 0, sizeof(result));
+    if (seed_diagonal(s1Len, c2, s2Len, k, seeds.workspace, diagonal)
+            && sw_banded_stats(c1, s1Len, c2, s2Len,
+                -parameters->open, -parameters->gap, local_data->matrix,
+                diagonal, band, seeds.workspace, result)
+            && result.score == score
+            && is_edge(&result, s1Len, SELF[i], s2Len, SELF[j],
+                parameters->AOL, parameters->SIM, parameters->OS,
+                sscore, max_len)) {
+        return true;
+    }
+
+    ++stats.unbanded;
+    return false;
+}
+
 static void sa_task(long long task_id, local_data_t *local_data)
 {
-    size_t block_size = (size_t)local_data->parameters->sa_block_size;
-    size_t id1;
-    size_t id2;
-    if (task_id >= 0) {
-        unsigned long result[2];
-        k_combination2(task_id, result);
-        id1 = result[0];
-        id2 = result[1];
+    AlignStats *stats_align = local_data->stats_align;
+    SuffixArrayStats *stats_sa = local_data->stats_sa;
+    PairVec vpairs;
+    const uint64_t *pairs = NULL;
+    unsigned long work_before = 0;
+    unsigned long work = 0;
+    double time = MPI_Wtime();
+    double time_serial = 0.0;
+    double time_wait = 0.0;
+    double time_stream = 0.0;
+    double stall_before = stats_sa[0].time_stall.sum();
+
+    for (int worker=0; worker<NUM_WORKERS; ++worker) {
+        work_before += stats_align[worker].work;
+    }
+
+    time_stream = filter_task(task_id, local_data, vpairs,
+            local_data->parameters->pair_stream);
+    time_serial = MPI_Wtime() - time - time_stream;
+    time_wait = stats_sa[0].time_stall.sum() - stall_before;
+    pairs = vpairs.empty() ? NULL : &vpairs[0];
+    if (STEAL_publish(local_data->steal, pairs, vpairs.size())) {
+        long long begin;
+        long long end;
+        while (STEAL_claim(local_data->steal,
+                    NUM_WORKERS*STEAL_CLAIM_PER_WORKER, &begin, &end)) {
+            time_wait += align_pairs(local_data, pairs+begin, end-begin);
+        }
+        STEAL_retire(local_data->steal);
     }
     else {
-        id1 = id2 = (-task_id)-1;
+        time_wait += align_pairs(local_data, pairs, vpairs.size());
     }
-    size_t id1_beg = id1 * block_size;
-    size_t id2_beg = id2 * block_size;
-    size_t id1_end = id1_beg + block_size - 1;
-    size_t id2_end = id2_beg + block_size - 1;
+    time_serial -= MPI_Wtime();
+    write_edges(local_data, local_data->edge_results);
+    time_serial += MPI_Wtime();
+
+    /* all but one thread idle while the ESA is built and edges written */
+    stats_sa[0].time_wait.push_back(time_wait + time_serial*(NUM_WORKERS-1));
+
+    time = MPI_Wtime() - time;
+    for (int worker=0; worker<NUM_WORKERS; ++worker) {
+        work += stats_align[worker].work;
+    }
+    work -= work_before;
+    report_tile_cost(local_data, task_id, work, time);
+}
+
+/* generates the candidate pairs of the given tile */
+/* returns the seconds spent aligning pairs as they were found, or 0 if
+ * they were all left in vpairs */
+static double filter_task(
+        long long task_id,
+        local_data_t *local_data,
+        PairVec &vpairs,
+        bool stream)
+{
+    size_t id1;
+    size_t id2;
+    size_t id1_beg;
+    size_t id2_beg;
+    size_t id1_end;
+    size_t id2_end;
+    task_blocks(task_id, id1, id2);
+    block_range(local_data, id1, id1_beg, id1_end);
+    block_range(local_data, id2, id2_beg, id2_end);
     long beg1 = (*local_data->BEG)[id1_beg];
     long beg2 = (*local_data->BEG)[id2_beg];
-    long end1 = 0;
-    long end2 = 0;
+    long end1 = (*local_data->END)[id1_end];
+    long end2 = (*local_data->END)[id2_end];
     assert(id1 <= id2);
-    if (id1_end > local_data->n_sequences) {
-        id1_end = local_data->n_sequences - 1;
-    }
-    end1 = (*local_data->END)[id1_end];
-    if (id2_end > local_data->n_sequences) {
-        id2_end = local_data->n_sequences - 1;
-    }
-    end2 = (*local_data->END)[id2_end];
     long len1 = end1 - beg1 + 1;
     long len2 = end2 - beg2 + 1;
-    char *sequences = NULL;
-    int *SID = NULL;
+    TileView view;
     int cutoff = local_data->parameters->exact_match_length;
     int sid_crossover = 0;
     SuffixArrayStats *stats_sa = local_data->stats_sa;
+    TileWorkspace *workspace = local_data->workspace;
+    unsigned long faults = 0;
+    double time_stream = 0.0;
+    int step = 1;
+    bool verify = false;
 
     (*local_data->debug_out) << task_id
         << "\t" << id1
@@ -949,40 +2338,100 @@ static void sa_task(long long task_id, local_data_t *local_data)
         << "\tbegin"
         << endl;
 
+    /* a whole-database engine serves one query block per task */
+    if (local_data->parameters->filter_engine != "esa") {
+        assert(id1 == id2);
+        query_filter(local_data, id1, stats_sa[0], vpairs);
+        (*local_data->debug_out) << task_id
+            << "\t" << id1
+            << "\t" << id2
+            << "\tend"
+            << endl;
+        return 0.0;
+    }
+
+    /* blocks without a common cutoff-mer cannot produce a pair; charge the
+     * skipped tile at the average ESA seconds per suffix seen so far */
+    if (id1 != id2 && !local_data->block_signatures.empty()
+            && !signatures_intersect(local_data->block_signatures[id1],
+                                     local_data->block_signatures[id2])) {
+        double per_suffix = 0.0;
+        if (stats_sa[0].suffixes.sum() > 0.0) {
+            per_suffix = (stats_sa[0].time_build.sum()
+                    + stats_sa[0].time_process.sum())
+                / stats_sa[0].suffixes.sum();
+        }
+        vpairs.clear();
+        stats_sa[0].skipped++;
+        stats_sa[0].time_skipped.push_back(per_suffix * (len1+len2));
+        (*local_data->debug_out) << task_id
+            << "\t" << id1
+            << "\t" << id2
+            << "\tskipped"
+            << endl;
+        return 0.0;
+    }
+
+    faults = TileWorkspace::page_faults();
+    view.sequences = local_data->sequences;
+    view.beg[0] = beg1;
+    view.len[0] = len1;
     if (id1 == id2) {
-        sequences = new char[len1+1];
-        SID = new int[len1];
-        copy(&local_data->sequences[beg1],
-             &local_data->sequences[beg1+len1],
-             &sequences[0]);
-        copy(&local_data->SID[beg1],
-             &local_data->SID[beg1+len1],
-             &SID[0]);
-        sequences[len1] = '\0';
-        SA_filter(local_data, SID, sequences, len1, local_data->sentinal, sid_crossover, cutoff, stats_sa[0]);
+        view.beg[1] = beg1 + len1;
+        view.len[1] = 0;
     }
     else {
-        sequences = new char[len1+len2+1];
-        SID = new int[len1+len2];
-        copy(&local_data->sequences[beg1],
-             &local_data->sequences[beg1+len1],
-             &sequences[0]);
-        copy(&local_data->SID[beg1],
-             &local_data->SID[beg1+len1],
-             &SID[0]);
-        copy(&local_data->sequences[beg2],
-             &local_data->sequences[beg2+len2],
-             &sequences[len1]);
-        copy(&local_data->SID[beg2],
-             &local_data->SID[beg2+len2],
-             &SID[len1]);
+        view.beg[1] = beg2;
+        view.len[1] = len2;
         sid_crossover = id2_beg;
-        sequences[len1+len2] = '\0';
-        SA_filter(local_data, SID, sequences, len1+len2, local_data->sentinal, sid_crossover, cutoff, stats_sa[0]);
+    }
+    /* a step above the cutoff could miss matches entirely */
+    step = max(1, min(local_data->parameters->sa_sparse_step, cutoff));
+    verify = local_data->parameters->sa_sparse_verify && step > 1 && id1 != id2;
+    if (verify) {
+        stream = false;
+    }
+    time_stream = SA_filter(local_data, view, sid_crossover, cutoff,
+            id1, id2, stats_sa[0], vpairs, stream, step);
+
+    /* filter the tile again in full and count the differences, both
+     * pair lists being sorted and unique */
+    if (verify) {
+        SuffixArrayStats scratch;
+        PairVec full;
+        unsigned long missing = 0;
+        unsigned long extra = 0;
+        size_t a = 0;
+        size_t b = 0;
+        SA_filter(local_data, view, sid_crossover, cutoff,
+                id1, id2, scratch, full, false, 1);
+        while (a < full.size() || b < vpairs.size()) {
+            if (b == vpairs.size() || (a < full.size() && full[a] < vpairs[b])) {
+                ++missing;
+                ++a;
+            }
+            else if (a == full.size() || vpairs[b] < full[a]) {
+                ++extra;
+                ++b;
+            }
+            else {
+                ++a;
+                ++b;
+            }
+        }
+        stats_sa[0].missing += missing;
+        stats_sa[0].extra += extra;
+        (*local_data->debug_out) << "sparse verify: full " << full.size()
+            << "\tsparse " << vpairs.size()
+            << "\tmissing " << missing
+            << "\textra " << extra
+            << endl;
     }
 
-    delete [] sequences;
-    delete [] SID;
+    stats_sa[0].faults.push_back(TileWorkspace::page_faults() - faults);
+    if (workspace->peak() > stats_sa[0].workspace) {
+        stats_sa[0].workspace = workspace->peak();
+    }
 
     (*local_data->debug_out) << task_id
         << "\t" << id1
@@ -990,6 +2439,730 @@ static void sa_task(long long task_id, local_data_t *local_data)
         << "\tend"
         << endl;
 
+    return time_stream;
+}
+
+/* aligns the given pairs using every OpenMP thread; returns the seconds
+ * the threads spent, summed, waiting for the slowest one to finish */
+static double align_pairs(
+        local_data_t *local_data,
+        const uint64_t *pairs,
+        long long count)
+{
+    double time = MPI_Wtime();
+    double time_wait = 0.0;
+
+#pragma omp parallel reduction(+:time_wait)
+    {
+        int thd = omp_get_thread_num();
+        double t;
+#pragma omp for schedule(guided) nowait
+        for (long long index=0; index<count; ++index) {
+            int i = pair_first(pairs[index]);
+            int j = pair_second(pairs[index]);
+            alignment_task(i, j, local_data, thd);
+        }
+        t = MPI_Wtime();
+#pragma omp barrier
+        time_wait += MPI_Wtime() - t;
+    }
+    time = MPI_Wtime() - time;
+    (*local_data->debug_out) << "align time: " << time << endl;
+    (*local_data->debug_out) << "time per align: " << time/count << endl;
+
+    return time_wait;
+}
+
+/* Once out of tiles, aligns pairs taken from ranks still working on
+ * large ones until every rank is done. */
+static void steal_tasks(local_data_t *local_data)
+{
+    SuffixArrayStats *stats_sa = local_data->stats_sa;
+    uint64_t *pairs = NULL;
+    long long count = 0;
+
+    STEAL_finish(local_data->steal);
+    while ((count = STEAL_steal(local_data->steal, &pairs)) > 0) {
+        double time_wait = align_pairs(local_data, pairs, count);
+        free(pairs);
+        stats_sa[0].time_wait.push_back(time_wait);
+        write_edges(local_data, local_data->edge_results);
+    }
+}
+
+/* Candidate pairs of the sequences of one block with every later sequence
+ * of the database the whole-database index pairs them with, sorted and
+ * unique. */
+static void query_filter(
+        local_data_t *local_data,
+        size_t block,
+        SuffixArrayStats &stats_sa,
+        PairVec &vpairs)
+{
+    const MinimizerIndex *minimizers = local_data->minimizers;
+    vector<long> &BEG = *(local_data->BEG);
+    vector<long> &END = *(local_data->END);
+    vector<PairVec> thread_pairs(NUM_WORKERS);
+    vector<size_t> thread_offset(NUM_WORKERS+1, 0);
+    unsigned long generated = 0;
+    unsigned long heavy = 0;
+    size_t seq_beg;
+    size_t seq_end;
+    double time_process = MPI_Wtime();
+
+    if (stats_sa.time_first == 0.0) {
+        stats_sa.time_first = time_process;
+    }
+
+    block_range(local_data, block, seq_beg, seq_end);
+
+#pragma omp parallel reduction(+:generated,heavy)
+    {
+        PairVec &pairs = thread_pairs[omp_get_thread_num()];
+        vector<int> ids;
+#pragma omp for schedule(dynamic, 16) nowait
+        for (long s=(long)seq_beg; s<=(long)seq_end; ++s) {
+            ids.clear();
+            if (NULL != minimizers) {
+                generated += minimizers->partners(s, ids);
+            }
+            else {
+                generated += fm_partners(local_data, s, ids, heavy);
+            }
+            for (size_t i=0; i<ids.size(); ++i) {
+                pairs.push_back(pair_key(s, ids[i]));
+            }
+        }
+    }
+
+    for (int t=0; t<NUM_WORKERS; ++t) {
+        thread_offset[t+1] = thread_offset[t] + thread_pairs[t].size();
+    }
+    vpairs.resize(thread_offset[NUM_WORKERS]);
+    for (int t=0; t<NUM_WORKERS; ++t) {
+        copy(thread_pairs[t].begin(), thread_pairs[t].end(),
+                vpairs.begin() + thread_offset[t]);
+        PairVec().swap(thread_pairs[t]);
+    }
+    /* each sequence appears first in one thread only, so sorting is all
+     * the deduplication needed */
+    radix_sort_unique(vpairs);
+    time_process = MPI_Wtime() - time_process;
+
+    (*local_data->debug_out) << "query time: " << time_process << endl;
+    (*local_data->debug_out) << "generated pairs: " << generated << endl;
+    (*local_data->debug_out) << "unique pairs: " << vpairs.size() << endl;
+
+    stats_sa.arrays++;
+    stats_sa.suffixes.push_back(END[seq_end] - BEG[seq_beg] + 1);
+    stats_sa.pairs.push_back(generated);
+    stats_sa.unique.push_back(vpairs.size());
+    if (NULL == minimizers && local_data->parameters->heavy_interval_width > 0) {
+        stats_sa.heavy.push_back(heavy);
+    }
+    stats_sa.time_process.push_back(time_process);
+    stats_sa.time_last = MPI_Wtime();
+}
+
+/* Every later sequence sharing a cutoff-mer with sequence s, both
+ * occurrences starting outside masked regions, which is the pairing rule
+ * of the ESA. Appends them sorted and unique to ids and returns how many
+ * occurrences were found before deduplication. As process_heavy does for
+ * the ESA, a window occurring more than HeavyIntervalWidth times adds each
+ * of its sequences once without checking left maximality, and is counted
+ * in heavy. */
+static size_t fm_partners(local_data_t *local_data, long s, vector<int> &ids,
+        unsigned long &heavy)
+{
+    const FMIndex *fm = local_data->fm_index;
+    const char *sequences = local_data->sequences;
+    const vector<uint64_t> &mask = local_data->mask;
+    int *SID = local_data->SID;
+    long beg = (*local_data->BEG)[s];
+    long end = (*local_data->END)[s];
+    long cutoff = local_data->parameters->exact_match_length;
+    long width = local_data->parameters->heavy_interval_width;
+    size_t before = ids.size();
+    size_t found = 0;
+    bool last_heavy = false;
+
+    for (long i=beg; i+cutoff<=end; ++i) {
+        long lo;
+        long hi;
+        if (!mask.empty() && is_masked(mask, i)) {
+            last_heavy = false;
+            continue;
+        }
+        fm->find(&sequences[i], cutoff, lo, hi);
+        /* the window itself is always one of the rows */
+        if (hi - lo < 2) {
+            last_heavy = false;
+            continue;
+        }
+        if (width > 0 && hi - lo > width) {
+            long ext_lo;
+            long ext_hi;
+            ++heavy;
+            /* when every occurrence extends one residue to the left, they
+             * are those of the previous window shifted by one, whose
+             * sequences are already in; masks break that correspondence */
+            if (last_heavy && mask.empty()) {
+                fm->find(&sequences[i-1], cutoff+1, ext_lo, ext_hi);
+                if (ext_hi - ext_lo == hi - lo) {
+                    continue;
+                }
+            }
+            last_heavy = true;
+            for (long row=lo; row<hi; ++row) {
+                long pos = fm->locate(row);
+                if (SID[pos] > s && (mask.empty() || !is_masked(mask, pos))) {
+                    ids.push_back(SID[pos]);
+                    ++found;
+                }
+            }
+            continue;
+        }
+        last_heavy = false;
+        for (long row=lo; row<hi; ++row) {
+            long pos = fm->locate(row);
+            if (SID[pos] <= s || (!mask.empty() && is_masked(mask, pos))) {
+                continue;
+            }
+            /* as the ESA checks the BWT, skip a match the previous window
+             * already found extended one residue to the left */
+            if (i > beg && sequences[pos-1] == sequences[i-1]
+                    && (mask.empty() || (!is_masked(mask, i-1)
+                            && !is_masked(mask, pos-1)))) {
+                continue;
+            }
+            ids.push_back(SID[pos]);
+            ++found;
+        }
+    }
+
+    sort(ids.begin() + before, ids.end());
+    ids.erase(unique(ids.begin() + before, ids.end()), ids.end());
+
+    return found;
+}
+
+/* writes and then clears the given per-worker edge buffers */
+static void write_edges(
+        local_data_t *local_data,
+        vector<EdgeResult> *edge_results)
+{
+    if (local_data->parameters->output_to_disk) {
+        for (int worker=0; worker<NUM_WORKERS; ++worker) {
+            size_t limit = edge_results[worker].size();
+            for (size_t i=0; i<limit; ++i) {
+                (*local_data->edge_out) << edge_results[worker][i] << endl;
+            }
+            edge_results[worker].clear();
+        }
+        local_data->edge_out->flush();
+    }
+}
+
+/* claims the next tile from the counter, false once they are exhausted */
+static bool get_task(
+        NXTVAL_t *nxt,
+        local_data_t *local_data,
+        long long &task_id)
+{
+    long long index = NXTVAL_get(nxt);
+    (*local_data->debug_out) << "NXTVAL_get: " << index << endl;
+    if (index >= local_data->tiles) {
+        return false;
+    }
+    if (local_data->tile_order.empty()) {
+        task_id = index;
+    }
+    else {
+        task_id = local_data->tile_order[index+local_data->parts];
+    }
+    return true;
+}
+
+/* Two-stage tile pipeline. While the worker threads align the pairs of
+ * the current tile, the master thread writes the edges of the previous
+ * tile, claims the next tile and builds its ESA and candidate pairs. Edge
+ * buffers are double-buffered so output never blocks alignment. The
+ * master thread makes all MPI calls, so MPI_THREAD_FUNNELED suffices. */
+static void pipelined_tasks(NXTVAL_t *nxt, local_data_t *local_data)
+{
+    AlignStats *stats_align = local_data->stats_align;
+    SuffixArrayStats *stats_sa = local_data->stats_sa;
+    vector<EdgeResult> *edges_aligning = local_data->edge_results;
+    vector<EdgeResult> *edges_writing = local_data->edge_results_spare;
+    PairVec current;
+    PairVec next;
+    long long task_id = 0;
+    long long next_task_id = 0;
+    bool have_task = false;
+    bool have_next = false;
+    double time_filter = MPI_Wtime();
+
+    have_task = get_task(nxt, local_data, task_id);
+    if (have_task) {
+        filter_task(task_id, local_data, current, false);
+    }
+    time_filter = MPI_Wtime() - time_filter;
+    /* nothing to overlap the first tile with */
+    stats_sa[0].time_wait.push_back(time_filter*(NUM_WORKERS-1));
+
+    while (have_task) {
+        unsigned long work_before = 0;
+        unsigned long work = 0;
+        double time_align = MPI_Wtime();
+        double time_overlap = 0.0;
+        double time_wait = 0.0;
+        double time_next = 0.0;
+
+        for (int worker=0; worker<NUM_WORKERS; ++worker) {
+            work_before += stats_align[worker].work;
+        }
+
+        local_data->edge_results = edges_aligning;
+#pragma omp parallel reduction(+:time_wait)
+        {
+            int thd = omp_get_thread_num();
+            double t;
+#pragma omp master
+            {
+                double t_filter = 0.0;
+                t = MPI_Wtime();
+                write_edges(local_data, edges_writing);
+                have_next = get_task(nxt, local_data, next_task_id);
+                t_filter = MPI_Wtime();
+                if (have_next) {
+                    filter_task(next_task_id, local_data, next, false);
+                }
+                time_next = MPI_Wtime() - t_filter;
+                time_overlap = MPI_Wtime() - t;
+            }
+#pragma omp for schedule(guided) nowait
+            for (long long index=0; index<(long long)current.size(); ++index) {
+                int i = pair_first(current[index]);
+                int j = pair_second(current[index]);
+                alignment_task(i, j, local_data, thd);
+            }
+            t = MPI_Wtime();
+#pragma omp barrier
+            time_wait += MPI_Wtime() - t;
+        }
+        time_align = MPI_Wtime() - time_align;
+
+        for (int worker=0; worker<NUM_WORKERS; ++worker) {
+            work += stats_align[worker].work;
+        }
+        work -= work_before;
+        stats_sa[0].time_overlap.push_back(time_overlap);
+        stats_sa[0].time_wait.push_back(time_wait);
+        (*local_data->debug_out) << "pipeline: " << task_id
+            << "\talign " << time_align
+            << "\toverlap " << time_overlap
+            << "\twait " << time_wait
+            << endl;
+        report_tile_cost(local_data, task_id, work, time_filter + time_align);
+
+        swap(edges_aligning, edges_writing);
+        current.swap(next);
+        next.clear();
+        task_id = next_task_id;
+        have_task = have_next;
+        time_filter = time_next;
+    }
+
+    write_edges(local_data, edges_writing);
+    local_data->edge_results = edges_aligning;
+}
+
+static void report_tile_cost(
+        local_data_t *local_data,
+        long long task_id,
+        unsigned long work,
+        double seconds)
+{
+    if (!local_data->tile_costs.empty()) {
+        (*local_data->debug_out) << "tile cost: " << task_id
+            << "\tpredicted " << local_data->tile_costs[task_id+local_data->parts]
+            << "\tactual " << work
+            << "\tseconds " << seconds
+            << endl;
+    }
+}
+
+static void task_blocks(long long task_id, size_t &id1, size_t &id2)
+{
+    if (task_id >= 0) {
+        unsigned long result[2];
+        k_combination2(task_id, result);
+        id1 = result[0];
+        id2 = result[1];
+    }
+    else {
+        id1 = id2 = (-task_id)-1;
+    }
+}
+
+/* first and last sequence index of the given block */
+static void block_range(
+        local_data_t *local_data,
+        size_t block,
+        size_t &seq_beg,
+        size_t &seq_end)
+{
+    if (!local_data->block_start.empty()) {
+        seq_beg = local_data->block_start[block];
+        seq_end = local_data->block_start[block+1] - 1;
+        return;
+    }
+
+    size_t block_size = (size_t)local_data->parameters->sa_block_size;
+    seq_beg = block * block_size;
+    seq_end = seq_beg + block_size - 1;
+    if (seq_end >= (size_t)local_data->n_sequences) {
+        seq_end = local_data->n_sequences - 1;
+    }
+}
+
+/* Estimated peak bytes of a tile with the given number of candidate pairs,
+ * beyond the sequences and indexes every rank holds anyway. The workspace
+ * slots of the ESA are counted as TileWorkspace rounds them. The builder's
+ * scratch is freed before the traversal gathers its pairs, so only the
+ * larger of the two counts. Pairs are counted as gathered even with
+ * PairStream, which falls back to gathering when the bitmap is too large.
+ * A chunk's buffer holds at most pair_compact keys, or twice its unique
+ * pairs once compacted, and each key takes PAIR_PEAK_KEYS at the gather.
+ * Kept across tiles are the cached block ESAs, all taken as large as the
+ * tile's blocks, and the stream bitmap's slot. Slots never shrink, but
+ * each is largest for the largest tile, which is the one budgeted.
+ *
+ * Taking every pair as a candidate is the margin: real tiles gather a
+ * fraction of them. A pair found in several chunks is counted once, so a
+ * tile of near-identical sequences can still go over. */
+static double tile_bytes(
+        local_data_t *local_data,
+        double residues,
+        double pairs)
+{
+    const Parameters *parameters = local_data->parameters;
+    double wide = min((double)parameters->sa_wide_residues, (double)INT_MAX);
+    double key = PAIR_PEAK_KEYS*sizeof(uint64_t);
+    double chunks = ESA_CHUNKS_PER_WORKER*NUM_WORKERS;
+    size_t n = residues;
+    size_t index = sizeof(int);
+    double scratch = ESA_SCRATCH_NARROW;
+    double slots = 0.0;
+    double resident = 0.0;
+
+    if (residues >= wide) {
+        index = sizeof(long);
+        scratch = ESA_SCRATCH_WIDE;
+        slots += TileWorkspace::rounded(n*sizeof(long)); /* WS_LCP_WIDE */
+    }
+    slots += TileWorkspace::rounded(n*index)            /* WS_SA */
+        + TileWorkspace::rounded(n*sizeof(int))         /* WS_LCP */
+        + TileWorkspace::rounded(n*sizeof(unsigned char)) /* WS_BWT */
+        + TileWorkspace::rounded(n*sizeof(int));        /* WS_SID_SA */
+    if (parameters->pair_stream) {
+        slots += TileWorkspace::rounded(max(n*sizeof(int),
+                    PAIR_COMPACT_SIZE*sizeof(uint64_t))); /* WS_SEEN */
+    }
+    if (parameters->sa_block_cache > 0) {
+        resident += max(2, parameters->sa_block_cache)
+            * (residues/2) * (2*sizeof(int));
+    }
+    return slots + resident + max(residues * scratch,
+            key * (chunks*local_data->pair_compact + 2*pairs));
+}
+
+/* Splits the sequences into blocks of at least two sequences such that a
+ * tile made of two copies of any block, with every pair of its sequences a
+ * candidate, fits in budget bytes. Since tile_bytes grows with residues
+ * and S1*S2 <= (S1^2+S2^2)/2, a tile of two different blocks fits too.
+ * Blocks whose first two sequences alone exceed the budget stay at two. */
+static void budget_blocks(
+        local_data_t *local_data,
+        size_t budget,
+        vector<long> &block_start)
+{
+    const vector<long> &BEG = *(local_data->BEG);
+    const vector<long> &END = *(local_data->END);
+    long n = local_data->n_sequences;
+
+    block_start.clear();
+    for (long s=0; s<n; /*nope*/) {
+        long first = s;
+        double residues = 0.0;
+        block_start.push_back(first);
+        while (s < n) {
+            double r = END[s] - BEG[s] + 1;
+            double count = s - first + 1;
+            if (s - first >= 2
+                    && tile_bytes(local_data, 2*(residues+r), count*count) > budget) {
+                break;
+            }
+            residues += r;
+            ++s;
+        }
+    }
+    /* a trailing block of one sequence joins the previous one */
+    if (block_start.size() > 1 && n - block_start.back() == 1) {
+        block_start.pop_back();
+    }
+    block_start.push_back(n);
+}
+
+/* prints the block map summary and writes the map to the debug file */
+static void report_blocks(local_data_t *local_data, size_t budget)
+{
+    const vector<long> &BEG = *(local_data->BEG);
+    const vector<long> &END = *(local_data->END);
+    long parts = local_data->parts;
+    Stats residues;
+    Stats sequences;
+    double largest = 0.0;
+
+    for (long b=0; b<parts; ++b) {
+        size_t seq_beg;
+        size_t seq_end;
+        block_range(local_data, b, seq_beg, seq_end);
+        double r = END[seq_end] - BEG[seq_beg] + 1;
+        double count = seq_end - seq_beg + 1;
+        residues.push_back(r);
+        sequences.push_back(count);
+        largest = max(largest, tile_bytes(local_data, 2*r, count*count));
+        if (local_data->debug_out) {
+            (*local_data->debug_out) << "block " << b
+                << "\tsequences " << seq_beg << ".." << seq_end
+                << "\tresidues " << r
+                << endl;
+        }
+    }
+
+    if (0 == local_data->rank) {
+        cout << "block budget " << budget << " bytes per tile" << endl;
+        cout << "           " << Stats::header() << endl;
+        cout << "  residues " << residues << endl;
+        cout << " sequences " << sequences << endl;
+        cout << "largest tile estimate " << largest << " bytes" << endl;
+    }
+}
+
+/* sorted, unique hashes of every cutoff-mer of a sequence */
+static void kmer_hashes(
+        const char *seq,
+        long len,
+        int cutoff,
+        vector<unsigned long> &hashes)
+{
+    hashes.clear();
+    for (long i=0; i+cutoff<=len; ++i) {
+        unsigned long h = 5381;
+        for (int k=0; k<cutoff; ++k) {
+            h = h * 33 + (unsigned char)seq[i+k];
+        }
+        hashes.push_back(h);
+    }
+    sort(hashes.begin(), hashes.end());
+    hashes.erase(unique(hashes.begin(), hashes.end()), hashes.end());
+}
+
+static bool shares_kmer(
+        const vector<unsigned long> &a,
+        const vector<unsigned long> &b)
+{
+    size_t i = 0;
+    size_t j = 0;
+    while (i < a.size() && j < b.size()) {
+        if (a[i] < b[j]) ++i;
+        else if (b[j] < a[i]) ++j;
+        else return true;
+    }
+    return false;
+}
+
+/* Predicted cost of every tile, indexed by task_id+parts, in cell updates.
+ * Aligning every pair of blocks i and j costs R_i*R_j cell updates where R
+ * is the residue count of a block (half that for the diagonal); this is
+ * scaled by the fraction of sampled sequence pairs that share an exact
+ * match of the cutoff length, when samples > 0. */
+static void tile_costs(
+        local_data_t *local_data,
+        long parts,
+        long tiles,
+        int samples,
+        vector<double> &costs)
+{
+    const vector<long> &BEG = *(local_data->BEG);
+    const vector<long> &END = *(local_data->END);
+    int cutoff = local_data->parameters->exact_match_length;
+    vector<double> residues(parts);
+    vector<vector<vector<unsigned long> > > sampled(parts);
+
+    for (long b=0; b<parts; ++b) {
+        size_t seq_beg;
+        size_t seq_end;
+        block_range(local_data, b, seq_beg, seq_end);
+        residues[b] = END[seq_end] - BEG[seq_beg] + 1;
+        if (samples > 0) {
+            size_t count = seq_end - seq_beg + 1;
+            size_t stride = count > (size_t)samples ? count / samples : 1;
+            for (size_t s=seq_beg; s<=seq_end; s+=stride) {
+                if (sampled[b].size() == (size_t)samples) break;
+                sampled[b].push_back(vector<unsigned long>());
+                kmer_hashes(&local_data->sequences[BEG[s]],
+                        END[s]-BEG[s], cutoff, sampled[b].back());
+            }
+        }
+    }
+
+    costs.assign(parts+tiles, 0.0);
+#pragma omp parallel for schedule(dynamic,64)
+    for (long long t=0; t<parts+tiles; ++t) {
+        long long task_id = t - parts;
+        size_t id1;
+        size_t id2;
+        double work;
+        double density = 1.0;
+        task_blocks(task_id, id1, id2);
+        if (id1 == id2) {
+            work = residues[id1] * residues[id1] / 2.0;
+        }
+        else {
+            work = residues[id1] * residues[id2];
+        }
+        if (samples > 0) {
+            const vector<vector<unsigned long> > &a = sampled[id1];
+            const vector<vector<unsigned long> > &b = sampled[id2];
+            unsigned long checked = 0;
+            unsigned long hits = 0;
+            for (size_t i=0; i<a.size(); ++i) {
+                for (size_t j=(id1==id2 ? i+1 : 0); j<b.size(); ++j) {
+                    ++checked;
+                    hits += shares_kmer(a[i], b[j]);
+                }
+            }
+            /* half a hit when nothing matched, so larger tiles still
+             * sort ahead of smaller ones */
+            density = checked ? (hits ? hits : 0.5) / checked : 1.0;
+        }
+        costs[t] = work * density
+            + TILE_COST_PER_RESIDUE * (residues[id1]
+                    + (id1 == id2 ? 0.0 : residues[id2]));
+    }
+}
+
+/* Bitmap of the cutoff-mers of every block, 2^bits bits each. A cutoff-mer
+ * never spans a sentinel, matching the clamped LCPs of the ESA, so two
+ * blocks whose bitmaps are disjoint share no exact match of that length. */
+static void block_signatures(
+        local_data_t *local_data,
+        long parts,
+        int bits,
+        vector<vector<uint64_t> > &signatures)
+{
+    const vector<long> &BEG = *(local_data->BEG);
+    const vector<long> &END = *(local_data->END);
+    const char *sequences = local_data->sequences;
+    int cutoff = local_data->parameters->exact_match_length;
+
+    assert(bits >= 6 && bits < 64);
+    signatures.assign(parts, vector<uint64_t>((1UL<<bits)/64, 0));
+#pragma omp parallel for schedule(dynamic)
+    for (long b=0; b<parts; ++b) {
+        vector<uint64_t> &signature = signatures[b];
+        size_t seq_beg;
+        size_t seq_end;
+        block_range(local_data, b, seq_beg, seq_end);
+        for (size_t s=seq_beg; s<=seq_end; ++s) {
+            const char *seq = &sequences[BEG[s]];
+            long len = END[s] - BEG[s];
+            for (long i=0; i+cutoff<=len; ++i) {
+                uint64_t h = 5381;
+                if (!local_data->mask.empty()
+                        && is_masked(local_data->mask, BEG[s]+i)) {
+                    continue;
+                }
+                for (int k=0; k<cutoff; ++k) {
+                    h = h * 33 + (unsigned char)seq[i+k];
+                }
+                /* Fibonacci hashing spreads djb2 over the top bits */
+                h = (h * 0x9E3779B97F4A7C15ULL) >> (64-bits);
+                signature[h/64] |= 1ULL << (h%64);
+            }
+        }
+    }
+}
+
+/* SEG-style mask: each residue covered by a window whose composition has
+ * less Shannon entropy than the given bits is masked. Windows never span
+ * two sequences. Returns the number of masked residues. */
+static unsigned long mask_low_complexity(
+        local_data_t *local_data,
+        int window,
+        double entropy,
+        vector<uint64_t> &mask)
+{
+    const vector<long> &BEG = *(local_data->BEG);
+    const vector<long> &END = *(local_data->END);
+    const char *sequences = local_data->sequences;
+    long n_seq = BEG.size();
+    vector<double> clog(window+1, 0.0);
+    double limit = 0.0;
+    unsigned long masked = 0;
+
+    /* the entropy of a window is log2(w) - sum(c*log2(c))/w over the
+     * residue counts c, so only the sum needs updating as it slides */
+    for (int c=1; c<=window; ++c) {
+        clog[c] = c * log((double)c) / log(2.0);
+    }
+    limit = window * (log((double)window) / log(2.0) - entropy);
+
+    mask.assign((END.back()+64)/64, 0);
+#pragma omp parallel for schedule(dynamic) reduction(+:masked)
+    for (long s=0; s<n_seq; ++s) {
+        const unsigned char *seq = (const unsigned char*)&sequences[BEG[s]];
+        long len = END[s] - BEG[s];
+        long masked_end = 0;
+        int counts[256] = {0};
+        double sum = 0.0;
+        for (long i=0; i<len; ++i) {
+            if (i >= window) {
+                unsigned char out = seq[i-window];
+                sum -= clog[counts[out]];
+                --counts[out];
+                sum += clog[counts[out]];
+            }
+            sum -= clog[counts[seq[i]]];
+            ++counts[seq[i]];
+            sum += clog[counts[seq[i]]];
+            if (i+1 >= window && sum > limit + 1e-9) {
+                for (long p=max(i+1-window, masked_end); p<=i; ++p) {
+                    long g = BEG[s] + p;
+#pragma omp atomic
+                    mask[g/64] |= uint64_t(1) << (g%64);
+                    ++masked;
+                }
+                masked_end = i+1;
+            }
+        }
+    }
+
+    return masked;
+}
+
+static bool signatures_intersect(
+        const vector<uint64_t> &a,
+        const vector<uint64_t> &b)
+{
+    for (size_t i=0; i<a.size(); ++i) {
+        if (a[i] & b[i]) {
+            return true;
+        }
+    }
+    return false;
 }
 
 static bool length_filter(size_t s1Len, size_t s2Len, size_t cutOff)
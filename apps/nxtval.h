@@ -10,6 +10,17 @@
 #define TAG_REQUEST 698825
 #define TAG_RESPONSE 698826
 
+/* where the shared counter lives */
+#define NXTVAL_BACKEND_SERVER 0 /* rank 0 thread or rank 0 as a server */
+#define NXTVAL_BACKEND_RMA    1 /* MPI-3 window on rank 0, MPI_Fetch_and_op */
+
+/* how NXTVAL_get claims indices from the shared counter */
+#define NXTVAL_CHUNK_SINGLE 0 /* one index per round trip */
+#define NXTVAL_CHUNK_GUIDED 1 /* guided self-scheduling, shrinking chunks */
+
+/* guided chunks are remaining/(NXTVAL_GUIDED_DIVISOR*size) */
+#define NXTVAL_GUIDED_DIVISOR 2
+
 void* nxtval_server(void *ignore)
 {
     MPI_Comm comm = MPI_COMM_WORLD;
@@ -36,13 +47,43 @@ typedef struct NXTVAL {
     int rank;
     int size;
     int provided;
+    int backend;
     pthread_t thread;
+    MPI_Win win;
+    long long *win_base;
     long long start;
     long long stop;
+    int chunk_mode;
+    long long chunk_min;
+    long long chunk_next; /* next index to hand out from the local chunk */
+    long long chunk_end;  /* one past the last index of the local chunk */
+    long long requests;   /* number of round trips made to the counter */
+    double time_get;      /* seconds spent waiting on the counter */
 } NXTVAL_t;
 
 
-static NXTVAL_t NXTVAL_init(long long start, long long stop)
+#if MPI_VERSION >= 3
+static void NXTVAL_init_rma(NXTVAL_t *nxt)
+{
+    MPI_Aint size = (0 == nxt->rank) ? sizeof(long long) : 0;
+
+    MPI_Win_allocate(size, sizeof(long long), MPI_INFO_NULL, nxt->comm,
+            &nxt->win_base, &nxt->win);
+    if (0 == nxt->rank) {
+        printf("starting nxtval as MPI-3 RMA window on rank 0\n");
+        fflush(stdout);
+        MPI_Win_lock(MPI_LOCK_EXCLUSIVE, 0, 0, nxt->win);
+        *nxt->win_base = nxt->start;
+        MPI_Win_unlock(0, nxt->win);
+    }
+    MPI_Barrier(nxt->comm);
+    MPI_Win_lock_all(MPI_MODE_NOCHECK, nxt->win);
+}
+#endif
+
+
+static NXTVAL_t NXTVAL_init(long long start, long long stop,
+        int backend, int chunk_mode, long long chunk_min)
 {
     NXTVAL_t nxt;
 
@@ -51,6 +92,15 @@ static NXTVAL_t NXTVAL_init(long long start, long long stop)
     MPI_Comm_size(nxt.comm, &nxt.size);
     nxt.start = start;
     nxt.stop = stop;
+    nxt.chunk_mode = chunk_mode;
+    nxt.chunk_min = chunk_min > 0 ? chunk_min : 1;
+    nxt.chunk_next = start;
+    nxt.chunk_end = start;
+    nxt.requests = 0;
+    nxt.time_get = 0.0;
+    nxt.backend = backend;
+    nxt.win = MPI_WIN_NULL;
+    nxt.win_base = NULL;
 
     MPI_Barrier(nxt.comm);
 
@@ -61,8 +111,23 @@ static NXTVAL_t NXTVAL_init(long long start, long long stop)
 
     MPI_Query_thread(&nxt.provided);
 
+#if MPI_VERSION < 3
+    if (NXTVAL_BACKEND_RMA == nxt.backend) {
+        if (0 == nxt.rank) {
+            printf("MPI-3 RMA not available, using nxtval_server\n");
+            fflush(stdout);
+        }
+        nxt.backend = NXTVAL_BACKEND_SERVER;
+    }
+#endif
+
     if (nxt.size > 1) {
-        if (MPI_THREAD_MULTIPLE == nxt.provided) {
+        if (NXTVAL_BACKEND_RMA == nxt.backend) {
+#if MPI_VERSION >= 3
+            NXTVAL_init_rma(&nxt);
+#endif
+        }
+        else if (MPI_THREAD_MULTIPLE == nxt.provided) {
             if (0 == nxt.rank) {
                 int rc;
                 long long *arg = (long long*)malloc(sizeof(long long));
@@ -103,11 +168,18 @@ static NXTVAL_t NXTVAL_init(long long start, long long stop)
 
 static void NXTVAL_stop(NXTVAL_t nxt)
 {
-    printf("%d: stopping nxtval\n", nxt.rank);
+    printf("%d: stopping nxtval after %lld requests, %f seconds\n",
+            nxt.rank, nxt.requests, nxt.time_get);
     fflush(stdout);
 
     if (nxt.size > 1) {
-        if (MPI_THREAD_MULTIPLE == nxt.provided) {
+        if (NXTVAL_BACKEND_RMA == nxt.backend) {
+#if MPI_VERSION >= 3
+            MPI_Win_unlock_all(nxt.win);
+            MPI_Win_free(&nxt.win);
+#endif
+        }
+        else if (MPI_THREAD_MULTIPLE == nxt.provided) {
             MPI_Barrier(nxt.comm);
             if (0 == nxt.rank) {
                 /* rank 0 stops the thread */
@@ -151,28 +223,71 @@ static void NXTVAL_stop(NXTVAL_t nxt)
 }
 
 
-static long long NXTVAL_get(NXTVAL_t nxt)
+/* Size of the next chunk to request. The remaining count is estimated from
+ * the last value this rank saw, so it can only overestimate; chunks still
+ * shrink as the counter advances and never drop below chunk_min. */
+static long long NXTVAL_chunk(NXTVAL_t *nxt)
 {
-    if (nxt.size > 1) {
-        if (MPI_THREAD_MULTIPLE != nxt.provided && 0 == nxt.rank) {
-            return nxt.stop;
+    long long chunk = 1;
+
+    if (NXTVAL_CHUNK_GUIDED == nxt->chunk_mode) {
+        long long remaining = nxt->stop - nxt->chunk_end;
+        long long divisor = (long long)NXTVAL_GUIDED_DIVISOR * nxt->size;
+        chunk = (remaining + divisor - 1) / divisor;
+        if (chunk < nxt->chunk_min) {
+            chunk = nxt->chunk_min;
+        }
+    }
+
+    return chunk;
+}
+
+
+static long long NXTVAL_get(NXTVAL_t *nxt)
+{
+    if (nxt->chunk_next < nxt->chunk_end) {
+        return nxt->chunk_next++;
+    }
+
+    if (nxt->size > 1) {
+        if (NXTVAL_BACKEND_SERVER == nxt->backend
+                && MPI_THREAD_MULTIPLE != nxt->provided && 0 == nxt->rank) {
+            return nxt->stop;
         }
         else {
-            MPI_Status status;
-            long long one=1;
+            long long chunk = NXTVAL_chunk(nxt);
             long long oldval;
-            MPI_Send(&one, 1, MPI_LONG_LONG, 0, TAG_REQUEST, nxt.comm);
-            MPI_Recv(&oldval, 1, MPI_LONG_LONG, 0, TAG_RESPONSE, nxt.comm, &status);
+            double t = MPI_Wtime();
+            if (NXTVAL_BACKEND_RMA == nxt->backend) {
+#if MPI_VERSION >= 3
+                MPI_Fetch_and_op(&chunk, &oldval, MPI_LONG_LONG,
+                        0, 0, MPI_SUM, nxt->win);
+                MPI_Win_flush(0, nxt->win);
+#endif
+            }
+            else {
+                MPI_Status status;
+                MPI_Send(&chunk, 1, MPI_LONG_LONG, 0, TAG_REQUEST, nxt->comm);
+                MPI_Recv(&oldval, 1, MPI_LONG_LONG, 0, TAG_RESPONSE, nxt->comm, &status);
+            }
+            nxt->time_get += MPI_Wtime() - t;
+            nxt->requests += 1;
+            if (oldval >= nxt->stop) {
+                nxt->chunk_next = nxt->chunk_end = nxt->stop;
+                return nxt->stop;
+            }
+            nxt->chunk_next = oldval + 1;
+            nxt->chunk_end = oldval + chunk;
+            if (nxt->chunk_end > nxt->stop) {
+                nxt->chunk_end = nxt->stop;
+            }
             return oldval;
         }
     }
     else {
-        static long long nxtval = nxt.start;
-        long long oldval = nxtval;
-        nxtval += 1;
-        return oldval;
+        /* single rank owns the whole range, no chunking needed */
+        return nxt->chunk_next < nxt->stop ? nxt->chunk_next++ : nxt->stop;
     }
 }
 
 #endif /* _NXTVAL_H_ */
-
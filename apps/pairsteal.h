@@ -0,0 +1,349 @@
+#ifndef _PAIRSTEAL_H_
+#define _PAIRSTEAL_H_
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <mpi.h>
+
+/* Work stealing of candidate pairs using MPI-3 passive target RMA.
+ *
+ * A rank holding more than threshold pairs of a tile publishes them. It
+ * then claims chunks for its own threads from the head of the range, while
+ * ranks out of tiles take half of whatever is left from the tail. Every
+ * rank holds a shared lock on the whole window from STEAL_init to
+ * STEAL_stop. Head and tail share one word that is only ever changed with
+ * MPI_Fetch_and_op: the owner adds its chunk to the head and a thief
+ * subtracts its slice from the tail, and each learns from the old value
+ * which pairs are its own, so the owner and its thieves never claim the
+ * same pair and never wait on each other's locks. A thief whose subtraction
+ * passed the head takes only the pairs above the head and adds the rest
+ * back. A thief counts itself in the owner's readers from before it looks
+ * at the range until its copy is done, and the owner waits for no readers
+ * before it retires its pairs. A rank sets its finished flag once it will
+ * never publish again; thieves stop when every other rank is finished and
+ * nothing is left to steal.
+ *
+ * Progress: a thief's atomics complete at the owner's window. Unless the
+ * MPI library progresses passive target RMA asynchronously, e.g. in
+ * hardware or with an asynchronous progress thread, they wait until the
+ * owner next enters MPI, which it does at least once per claimed chunk.
+ * A thief therefore claims its slice with a single atomic; a compare and
+ * swap after reading the range would keep finding the head moved by the
+ * owner's claim in between. Without asynchronous progress, stealing still
+ * terminates and loses no pairs, but thieves take longer to get their
+ * slices. */
+
+/* fields of the state every rank exposes */
+#define STEAL_RANGE    0 /* (head << 32) + tail of the published pairs; the
+                            head may pass the tail once all are claimed */
+#define STEAL_BASE     1 /* address of the published pairs */
+#define STEAL_FINISHED 2 /* nonzero once the owner publishes no more */
+#define STEAL_READERS  3 /* thieves that may still read the pairs */
+#define STEAL_FIELDS   4
+
+/* the head and the signed tail must each fit 32 bits; larger tiles are not
+ * published, and a thief takes at most STEAL_MAX_PAIRS / size pairs at once
+ * so that the tail stays above -STEAL_MAX_PAIRS while thieves add back */
+#define STEAL_MAX_PAIRS 0x40000000LL
+
+/* microseconds a thief waits after a sweep that found nothing, doubling
+ * after each such sweep up to the maximum */
+#define STEAL_BACKOFF_MIN 200
+#define STEAL_BACKOFF_MAX 12800
+
+typedef struct STEAL {
+    MPI_Comm comm;
+    int rank;
+    int size;
+    int enabled;
+    long long threshold;
+    MPI_Win win;
+    long long *state;
+    MPI_Aint *state_addr; /* address of the state on every rank */
+    const uint64_t *pairs; /* published pairs, attached to win */
+    long long count;
+    long long claimed;    /* published pairs claimed by this rank */
+    long long slice;      /* most pairs a thief takes at once */
+    int victim;           /* next rank a thief tries */
+    long long steals;     /* slices taken from other ranks */
+    long long stolen;     /* pairs in those slices */
+    long long lost;       /* own pairs taken by other ranks */
+    double time_steal;    /* seconds spent looking for pairs */
+} STEAL_t;
+
+
+/* Collective. Stealing is enabled when threshold > 0, there is more than
+ * one rank and MPI-3 RMA is available. An idle rank never has tiles of
+ * its own, e.g. rank 0 serving NXTVAL. */
+static STEAL_t STEAL_init(long long threshold, int idle)
+{
+    STEAL_t st;
+
+    st.comm = MPI_COMM_WORLD;
+    MPI_Comm_rank(st.comm, &st.rank);
+    MPI_Comm_size(st.comm, &st.size);
+    st.enabled = threshold > 0 && st.size > 1;
+    st.threshold = threshold;
+    st.win = MPI_WIN_NULL;
+    st.state = NULL;
+    st.state_addr = NULL;
+    st.pairs = NULL;
+    st.count = 0;
+    st.claimed = 0;
+    st.slice = STEAL_MAX_PAIRS / st.size;
+    st.victim = (st.rank + 1) % st.size;
+    st.steals = 0;
+    st.stolen = 0;
+    st.lost = 0;
+    st.time_steal = 0.0;
+
+#if MPI_VERSION < 3
+    if (st.enabled && 0 == st.rank) {
+        printf("MPI-3 RMA not available, pair stealing disabled\n");
+        fflush(stdout);
+    }
+    st.enabled = 0;
+#else
+    if (st.enabled) {
+        MPI_Aint addr;
+        st.state = (long long*)calloc(STEAL_FIELDS, sizeof(long long));
+        st.state_addr = (MPI_Aint*)malloc(st.size * sizeof(MPI_Aint));
+        st.state[STEAL_FINISHED] = idle ? 1 : 0;
+        MPI_Win_create_dynamic(MPI_INFO_NULL, st.comm, &st.win);
+        MPI_Win_attach(st.win, st.state, STEAL_FIELDS * sizeof(long long));
+        MPI_Get_address(st.state, &addr);
+        MPI_Allgather(&addr, 1, MPI_AINT, st.state_addr, 1, MPI_AINT, st.comm);
+        MPI_Win_lock_all(0, st.win);
+        if (0 == st.rank) {
+            printf("pair stealing above %lld pairs\n", threshold);
+            fflush(stdout);
+        }
+    }
+#endif
+
+    return st;
+}
+
+
+/* the rank after v, skipping this one */
+static int STEAL_next_victim(STEAL_t *st, int v)
+{
+    v = (v + 1) % st->size;
+    if (v == st->rank) {
+        v = (v + 1) % st->size;
+    }
+    return v;
+}
+
+
+#if MPI_VERSION >= 3
+static MPI_Aint STEAL_disp(STEAL_t *st, int target, int field)
+{
+    return st->state_addr[target] + field * sizeof(long long);
+}
+
+
+/* atomically applies op with value to a field; returns its old value */
+static long long STEAL_fetch_op(STEAL_t *st, int target, int field,
+        long long value, MPI_Op op)
+{
+    long long old = 0;
+    MPI_Fetch_and_op(&value, &old, MPI_LONG_LONG, target,
+            STEAL_disp(st, target, field), op, st->win);
+    MPI_Win_flush(target, st->win);
+    return old;
+}
+
+
+static long long STEAL_fetch(STEAL_t *st, int target, int field)
+{
+    return STEAL_fetch_op(st, target, field, 0, MPI_NO_OP);
+}
+
+#endif
+
+
+/* the tail is signed, so adding to either half with MPI_SUM is exact */
+static long long STEAL_range(long long head, long long tail)
+{
+    return head * 0x100000000LL + tail;
+}
+
+static long long STEAL_tail(long long range) { return (int32_t)range; }
+static long long STEAL_head(long long range)
+{
+    return (range - STEAL_tail(range)) / 0x100000000LL;
+}
+
+
+/* Offers the pairs to other ranks; returns 0 if there are too few, or too
+ * many to publish, in which case the caller aligns them all itself as
+ * usual. */
+static int STEAL_publish(STEAL_t *st, const uint64_t *pairs, long long count)
+{
+    if (!st->enabled || count <= st->threshold || count > STEAL_MAX_PAIRS) {
+        return 0;
+    }
+#if MPI_VERSION >= 3
+    MPI_Aint base;
+    st->pairs = pairs;
+    st->count = count;
+    st->claimed = 0;
+    MPI_Win_attach(st->win, (void*)pairs, count * sizeof(uint64_t));
+    MPI_Get_address((void*)pairs, &base);
+    /* the base is in place before any thief can claim a slice */
+    STEAL_fetch_op(st, st->rank, STEAL_BASE, (long long)base, MPI_REPLACE);
+    STEAL_fetch_op(st, st->rank, STEAL_RANGE, STEAL_range(0, count),
+            MPI_REPLACE);
+#endif
+    return 1;
+}
+
+
+/* Claims up to chunk of the published pairs for this rank; returns 0
+ * once none are left. */
+static int STEAL_claim(STEAL_t *st, long long chunk,
+        long long *begin, long long *end)
+{
+    *begin = *end = 0;
+#if MPI_VERSION >= 3
+    {
+        /* pairs below the tail as of the add are left to this rank */
+        long long range = STEAL_fetch_op(st, st->rank, STEAL_RANGE,
+                STEAL_range(chunk, 0), MPI_SUM);
+        long long head = STEAL_head(range);
+        long long tail = STEAL_tail(range);
+        if (head < tail) {
+            *begin = head;
+            *end = head + chunk < tail ? head + chunk : tail;
+            st->claimed += *end - *begin;
+        }
+    }
+#endif
+    return *end > *begin;
+}
+
+
+/* Withdraws the published pairs once STEAL_claim returned 0. */
+static void STEAL_retire(STEAL_t *st)
+{
+#if MPI_VERSION >= 3
+    /* the range is empty already; a thief still subtracting from it adds
+     * its slice back before it leaves the readers, after which the range
+     * stays fully claimed until the next publish replaces it */
+    st->lost += st->count - st->claimed;
+    while (STEAL_fetch(st, st->rank, STEAL_READERS) > 0) {
+        /* a thief is still copying its slice */
+    }
+    MPI_Win_detach(st->win, (void*)st->pairs);
+#endif
+    st->pairs = NULL;
+    st->count = 0;
+}
+
+
+/* Marks this rank as never publishing again. */
+static void STEAL_finish(STEAL_t *st)
+{
+#if MPI_VERSION >= 3
+    if (st->enabled) {
+        STEAL_fetch_op(st, st->rank, STEAL_FINISHED, 1, MPI_REPLACE);
+    }
+#endif
+}
+
+
+/* Takes half of the remaining pairs of some other rank into a malloc'd
+ * buffer and returns their count; returns 0 when every other rank is
+ * finished and none has pairs above the threshold. */
+static long long STEAL_steal(STEAL_t *st, uint64_t **pairs)
+{
+    long long count = 0;
+    double t = MPI_Wtime();
+    useconds_t backoff = STEAL_BACKOFF_MIN;
+
+    *pairs = NULL;
+#if MPI_VERSION >= 3
+    while (st->enabled) {
+        int finished = 0;
+        int k;
+        for (k = 1; k < st->size; ++k) {
+            int v = st->victim;
+            /* read first, so a rank found finished has retired its last
+             * pairs before the range below is read */
+            int done = 0 != STEAL_fetch(st, v, STEAL_FINISHED);
+            long long range;
+            long long left;
+            STEAL_fetch_op(st, v, STEAL_READERS, 1, MPI_SUM);
+            range = STEAL_fetch(st, v, STEAL_RANGE);
+            left = STEAL_tail(range) - STEAL_head(range);
+            if (left > st->threshold) {
+                /* the range may have shrunk since it was read; whatever of
+                 * the slice lies at or below the head as of the subtraction
+                 * is not taken and goes back */
+                long long slice = left / 2 < st->slice ? left / 2 : st->slice;
+                long long head, tail, mid;
+                range = STEAL_fetch_op(st, v, STEAL_RANGE,
+                        STEAL_range(0, -slice), MPI_SUM);
+                head = STEAL_head(range);
+                tail = STEAL_tail(range);
+                mid = tail - slice > head ? tail - slice : head;
+                count = tail > mid ? tail - mid : 0;
+                if (count < slice) {
+                    STEAL_fetch_op(st, v, STEAL_RANGE,
+                            STEAL_range(0, slice - count), MPI_SUM);
+                }
+                if (count > 0) {
+                    MPI_Aint base = (MPI_Aint)STEAL_fetch(st, v, STEAL_BASE);
+                    *pairs = (uint64_t*)malloc(count * sizeof(uint64_t));
+                    MPI_Get(*pairs, count, MPI_UINT64_T, v,
+                            base + mid * sizeof(uint64_t),
+                            count, MPI_UINT64_T, st->win);
+                    MPI_Win_flush(v, st->win);
+                }
+            }
+            STEAL_fetch_op(st, v, STEAL_READERS, -1, MPI_SUM);
+            if (count > 0) {
+                st->steals += 1;
+                st->stolen += count;
+                st->time_steal += MPI_Wtime() - t;
+                return count;
+            }
+            finished += done;
+            st->victim = STEAL_next_victim(st, v);
+        }
+        if (finished == st->size - 1) {
+            break;
+        }
+        usleep(backoff);
+        backoff = backoff < STEAL_BACKOFF_MAX/2 ? 2*backoff : STEAL_BACKOFF_MAX;
+    }
+#endif
+    st->time_steal += MPI_Wtime() - t;
+    return 0;
+}
+
+
+/* Collective; call after NXTVAL_stop. */
+static void STEAL_stop(STEAL_t st)
+{
+    if (!st.enabled) {
+        return;
+    }
+    printf("%d: stopping pair stealing after %lld steals of %lld pairs, "
+            "%lld pairs lost, %f seconds\n",
+            st.rank, st.steals, st.stolen, st.lost, st.time_steal);
+    fflush(stdout);
+#if MPI_VERSION >= 3
+    MPI_Win_unlock_all(st.win);
+    MPI_Win_detach(st.win, st.state);
+    MPI_Win_free(&st.win);
+    free(st.state);
+    free(st.state_addr);
+#endif
+}
+
+#endif /* _PAIRSTEAL_H_ */
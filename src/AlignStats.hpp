@@ -37,6 +37,13 @@ class AlignStats
         double time_total;
         unsigned long work;
         unsigned long work_skipped;
+        unsigned long profiles; /**< query profiles built */
+        double time_profile;    /**< seconds building query profiles */
+        unsigned long screened; /**< pairs given a score-only alignment */
+        unsigned long rejected; /**< screened pairs not aligned further */
+        double time_screen;     /**< seconds in score-only alignments */
+        unsigned long banded;   /**< pairs aligned within the band */
+        unsigned long unbanded; /**< banded pairs aligned again in full */
 
         AlignStats()
             : edge_counts(0)
@@ -47,6 +54,13 @@ class AlignStats
             , time_total(0.0)
             , work(0)
             , work_skipped(0)
+            , profiles(0)
+            , time_profile(0.0)
+            , screened(0)
+            , rejected(0)
+            , time_screen(0.0)
+            , banded(0)
+            , unbanded(0)
         { }
 
         static string header() {
@@ -60,6 +74,13 @@ class AlignStats
             os << setw(11) << "TimeTotal";
             os << setw(21) << "Cell_Updates";
             os << setw(21) << "Cell_Updates_Skipped";
+            os << setw(10) << "Profiles";
+            os << setw(12) << "TimeProfile";
+            os << setw(10) << "Screened";
+            os << setw(10) << "Rejected";
+            os << setw(12) << "TimeScreen";
+            os << setw(10) << "Banded";
+            os << setw(10) << "Unbanded";
             return os.str();
         }
 
@@ -72,7 +93,14 @@ class AlignStats
                << setw(10) << stats.time_kcomb
                << setw(11) << stats.time_total
                << setw(21) << stats.work
-               << setw(21) << stats.work_skipped;
+               << setw(21) << stats.work_skipped
+               << setw(10) << stats.profiles
+               << setw(12) << stats.time_profile
+               << setw(10) << stats.screened
+               << setw(10) << stats.rejected
+               << setw(12) << stats.time_screen
+               << setw(10) << stats.banded
+               << setw(10) << stats.unbanded;
             return os;
         }
 };
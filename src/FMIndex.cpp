@@ -0,0 +1,187 @@
+/**
+ * @file FMIndex.cpp
+ *
+ * @author agent@local
+ *
+ * Copyright 2026 agent. All rights reserved.
+ */
+#include "config.h"
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <new>
+#include <vector>
+
+#include "sais.h"
+#include "sais_omp.hpp"
+
+#include "FMIndex.hpp"
+
+using ::std::max;
+using ::std::vector;
+
+namespace pgraph {
+
+FMIndex::FMIndex(const char *text, long n, int sample)
+    : _rows(n+1)
+    , _sample(max(1, sample))
+    , _sigma(1)
+    , _C()
+    , _bwt()
+    , _occ()
+    , _sampled()
+    , _ranks()
+    , _positions()
+{
+    vector<long> counts(256, 0);
+
+    for (long i=0; i<n; ++i) {
+        ++counts[(unsigned char)text[i]];
+    }
+    memset(_codes, 0, sizeof(_codes));
+    for (int c=0; c<256; ++c) {
+        if (counts[c] > 0) {
+            _codes[c] = _sigma++;
+        }
+    }
+
+    /* code 0 is the end of the text, i.e. the empty suffix in row 0 */
+    _C.assign(_sigma + 1, 0);
+    _C[1] = 1;
+    for (int c=0; c<256; ++c) {
+        if (counts[c] > 0) {
+            _C[_codes[c] + 1] = counts[c];
+        }
+    }
+    for (int code=1; code<=_sigma; ++code) {
+        _C[code] += _C[code-1];
+    }
+
+    /* sais has no 64-bit variant; both need an LCP array, thrown away */
+    if (n < INT_MAX) {
+        vector<int> SA(n+1);
+        vector<int> LCP(n+1);
+        if (sais((const unsigned char *)text, &SA[0], &LCP[0], (int)n) != 0) {
+            throw std::bad_alloc();
+        }
+        vector<int>().swap(LCP);
+        build(text, &SA[0]);
+    }
+    else {
+        vector<long> SA(n+1);
+        vector<long> LCP(n+1);
+        if (sais_omp((const unsigned char *)text, &SA[0], &LCP[0], n) != 0) {
+            throw std::bad_alloc();
+        }
+        vector<long>().swap(LCP);
+        build(text, &SA[0]);
+    }
+}
+
+
+template <class Index>
+void FMIndex::build(const char *text, const Index *SA)
+{
+    long n = _rows - 1;
+    vector<uint64_t> running(_sigma, 0);
+
+    _bwt.resize(_rows);
+    _occ.resize((_rows/FM_OCC_INTERVAL + 1) * _sigma);
+    _sampled.assign(_rows/64 + 1, 0);
+    _positions.reserve(n/_sample + 1);
+
+    for (long row=0; row<_rows; ++row) {
+        long pos = 0 == row ? n : long(SA[row-1]);
+        unsigned char code = 0;
+        if (0 == row % FM_OCC_INTERVAL) {
+            std::copy(running.begin(), running.end(),
+                    _occ.begin() + (row/FM_OCC_INTERVAL) * _sigma);
+        }
+        if (pos > 0) {
+            code = _codes[(unsigned char)text[pos-1]];
+        }
+        _bwt[row] = code;
+        ++running[code];
+        if (0 == pos % _sample) {
+            _sampled[row/64] |= uint64_t(1) << (row%64);
+            _positions.push_back(pos);
+        }
+    }
+    if (0 == _rows % FM_OCC_INTERVAL) {
+        std::copy(running.begin(), running.end(),
+                _occ.begin() + (_rows/FM_OCC_INTERVAL) * _sigma);
+    }
+
+    _ranks.resize(_sampled.size());
+    uint64_t rank = 0;
+    for (size_t w=0; w<_sampled.size(); ++w) {
+        _ranks[w] = rank;
+        rank += __builtin_popcountll(_sampled[w]);
+    }
+}
+
+
+long FMIndex::occ(int code, long row) const
+{
+    long checkpoint = row / FM_OCC_INTERVAL;
+    long count = long(_occ[checkpoint * _sigma + code]);
+
+    for (long r=checkpoint*FM_OCC_INTERVAL; r<row; ++r) {
+        count += _bwt[r] == code;
+    }
+
+    return count;
+}
+
+
+void FMIndex::find(const char *pattern, long m, long &lo, long &hi) const
+{
+    lo = 0;
+    hi = _rows;
+    for (long i=m-1; i>=0 && lo<hi; --i) {
+        int code = _codes[(unsigned char)pattern[i]];
+        if (0 == code) {
+            /* a character the text lacks */
+            lo = hi = 0;
+            return;
+        }
+        lo = _C[code] + occ(code, lo);
+        hi = _C[code] + occ(code, hi);
+    }
+    if (lo >= hi) {
+        lo = hi = 0;
+    }
+}
+
+
+long FMIndex::locate(long row) const
+{
+    long steps = 0;
+    uint64_t below = 0;
+
+    /* position 0 is always sampled, so the end code is never followed */
+    while (!((_sampled[row/64] >> (row%64)) & 1)) {
+        int code = _bwt[row];
+        row = _C[code] + occ(code, row);
+        ++steps;
+    }
+    below = _sampled[row/64] & ((uint64_t(1) << (row%64)) - 1);
+
+    return _positions[_ranks[row/64] + __builtin_popcountll(below)] + steps;
+}
+
+
+size_t FMIndex::bytes() const
+{
+    return _C.capacity() * sizeof(long)
+        + _bwt.capacity()
+        + _occ.capacity() * sizeof(uint64_t)
+        + _sampled.capacity() * sizeof(uint64_t)
+        + _ranks.capacity() * sizeof(uint64_t)
+        + _positions.capacity() * sizeof(long);
+}
+
+}; /* namespace pgraph */
@@ -0,0 +1,81 @@
+/**
+ * @file FMIndex.hpp
+ *
+ * @author agent@local
+ *
+ * Copyright 2026 agent. All rights reserved.
+ *
+ * FM-index of a packed database: its BWT, occurrence counts checkpointed
+ * every FM_OCC_INTERVAL rows and the text positions of a sample of the
+ * suffix array rows. The full suffix array is only held while the index is
+ * built, so once built a row costs about three bytes instead of the
+ * thirteen of an ESA.
+ */
+#ifndef _PGRAPH_FM_INDEX_H_
+#define _PGRAPH_FM_INDEX_H_
+
+#include <stdint.h>
+
+#include <cstddef>
+#include <vector>
+
+namespace pgraph {
+
+class FMIndex
+{
+    public:
+        /** Rows between occurrence count checkpoints. */
+        static const long FM_OCC_INTERVAL = 128;
+
+        /**
+         * Indexes text[0..n-1].
+         *
+         * @param[in] text the packed database
+         * @param[in] n length of text
+         * @param[in] sample rows whose text position is a multiple of
+         *            sample keep it; locate walks at most sample-1 rows
+         */
+        FMIndex(const char *text, long n, int sample=32);
+
+        /**
+         * Backward searches pattern[0..m-1]. The rows of the suffixes it
+         * prefixes are [lo,hi), empty if it does not occur.
+         */
+        void find(const char *pattern, long m, long &lo, long &hi) const;
+
+        /** Text position of the suffix of the given row. */
+        long locate(long row) const;
+
+        /** Rows in the index, one per suffix plus the empty suffix. */
+        long rows() const { return _rows; }
+
+        /** Bytes held by the index. */
+        size_t bytes() const;
+
+    private:
+        /* fills the BWT, checkpoints and samples from the suffix array */
+        template <class Index>
+        void build(const char *text, const Index *SA);
+
+        /* occurrences of code in the BWT rows [0,row) */
+        long occ(int code, long row) const;
+
+        /* not copyable */
+        FMIndex(const FMIndex &);
+        FMIndex& operator=(const FMIndex &);
+
+        long _rows;
+        int _sample;
+        int _sigma;                     /* codes in use, 0 being the end */
+        int _codes[256];                /* code of each character */
+        std::vector<long> _C;           /* rows of suffixes below code c */
+        std::vector<unsigned char> _bwt;
+        std::vector<uint64_t> _occ;     /* per checkpoint, per code */
+        std::vector<uint64_t> _sampled; /* bit per row keeping its position */
+        std::vector<uint64_t> _ranks;   /* sampled rows before each word */
+        std::vector<long> _positions;   /* of the sampled rows, in order */
+};
+
+}; /* namespace pgraph */
+
+#endif /* _PGRAPH_FM_INDEX_H_ */
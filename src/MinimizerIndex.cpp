@@ -0,0 +1,191 @@
+/**
+ * @file MinimizerIndex.cpp
+ *
+ * @author agent@local
+ *
+ * Copyright 2026 agent. All rights reserved.
+ */
+#include "config.h"
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <deque>
+#include <utility>
+#include <vector>
+
+#include "MinimizerIndex.hpp"
+
+using ::std::deque;
+using ::std::lower_bound;
+using ::std::make_pair;
+using ::std::max;
+using ::std::min;
+using ::std::pair;
+using ::std::sort;
+using ::std::unique;
+using ::std::upper_bound;
+using ::std::vector;
+
+namespace pgraph {
+
+/* Bijective mix of a packed k-mer (the murmur3 finalizer). Ordering by the
+ * packed k-mer itself would make runs of A or poly-Q the minimizers of
+ * most windows. */
+static inline uint64_t mix(uint64_t x)
+{
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdULL;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ULL;
+    x ^= x >> 33;
+    return x;
+}
+
+
+MinimizerIndex::MinimizerIndex(
+        const char *sequences,
+        const vector<long> &BEG,
+        const vector<long> &END,
+        int k, int w,
+        const vector<uint64_t> &mask,
+        size_t max_sequences)
+    : _k(max(1, min(k, MAX_K)))
+    , _w(max(1, w))
+    , _dropped(0)
+    , _key_offsets()
+    , _ids()
+    , _seq_offsets()
+    , _seq_keys()
+{
+    long n_sequences = long(BEG.size());
+    vector<pair<uint64_t,int> > entries;
+    vector<pair<int,size_t> > seq_entries;
+    vector<uint64_t> hashes;
+
+    for (long s=0; s<n_sequences; ++s) {
+        sequence_minimizers(sequences, BEG[s], END[s], mask, hashes);
+        for (size_t h=0; h<hashes.size(); ++h) {
+            entries.push_back(make_pair(hashes[h], int(s)));
+        }
+    }
+    sort(entries.begin(), entries.end());
+
+    /* a minimizer of a single sequence pairs it with nothing */
+    _key_offsets.push_back(0);
+    for (size_t i=0; i<entries.size(); /* advanced below */) {
+        size_t j = i + 1;
+        while (j < entries.size() && entries[j].first == entries[i].first) {
+            ++j;
+        }
+        if (max_sequences > 0 && j - i > max_sequences) {
+            ++_dropped;
+        }
+        else if (j - i > 1) {
+            size_t key = _key_offsets.size() - 1;
+            for (size_t e=i; e<j; ++e) {
+                _ids.push_back(entries[e].second);
+                seq_entries.push_back(make_pair(entries[e].second, key));
+            }
+            _key_offsets.push_back(_ids.size());
+        }
+        i = j;
+    }
+    vector<pair<uint64_t,int> >().swap(entries);
+
+    /* bucket the kept minimizers by sequence */
+    _seq_offsets.assign(n_sequences + 1, 0);
+    for (size_t e=0; e<seq_entries.size(); ++e) {
+        ++_seq_offsets[seq_entries[e].first + 1];
+    }
+    for (long s=0; s<n_sequences; ++s) {
+        _seq_offsets[s+1] += _seq_offsets[s];
+    }
+    _seq_keys.resize(seq_entries.size());
+    {
+        vector<size_t> next(_seq_offsets.begin(), _seq_offsets.end() - 1);
+        for (size_t e=0; e<seq_entries.size(); ++e) {
+            _seq_keys[next[seq_entries[e].first]++] = seq_entries[e].second;
+        }
+    }
+}
+
+
+void MinimizerIndex::sequence_minimizers(
+        const char *sequences,
+        long beg,
+        long end,
+        const vector<uint64_t> &mask,
+        vector<uint64_t> &hashes) const
+{
+    const uint64_t code_mask = (uint64_t(1) << (5*_k)) - 1;
+    long n_kmers = end - beg - _k + 1;
+    /* k-mer positions whose hash may still be a window's minimum, their
+     * hashes increasing from front to back */
+    deque<pair<long,uint64_t> > window;
+    uint64_t code = 0;
+
+    hashes.clear();
+    if (n_kmers < _w) {
+        /* too short to hold a single window */
+        return;
+    }
+
+    for (long p=0; p<_k-1; ++p) {
+        code = (code << 5) | (sequences[beg+p] & 31);
+    }
+    for (long i=0; i<n_kmers; ++i) {
+        long g = beg + i;
+        code = ((code << 5) | (sequences[g+_k-1] & 31)) & code_mask;
+        if (mask.empty() || !((mask[g/64] >> (g%64)) & 1)) {
+            uint64_t hash = mix(code);
+            while (!window.empty() && window.back().second >= hash) {
+                window.pop_back();
+            }
+            window.push_back(make_pair(i, hash));
+        }
+        while (!window.empty() && window.front().first <= i - _w) {
+            window.pop_front();
+        }
+        if (i >= _w - 1 && !window.empty()) {
+            if (hashes.empty() || hashes.back() != window.front().second) {
+                hashes.push_back(window.front().second);
+            }
+        }
+    }
+
+    sort(hashes.begin(), hashes.end());
+    hashes.erase(unique(hashes.begin(), hashes.end()), hashes.end());
+}
+
+
+size_t MinimizerIndex::partners(int sid, vector<int> &ids) const
+{
+    size_t before = ids.size();
+    size_t found = 0;
+
+    for (size_t m=_seq_offsets[sid]; m<_seq_offsets[sid+1]; ++m) {
+        size_t key = _seq_keys[m];
+        vector<int>::const_iterator first = _ids.begin() + _key_offsets[key];
+        vector<int>::const_iterator last = _ids.begin() + _key_offsets[key+1];
+        first = upper_bound(first, last, sid);
+        ids.insert(ids.end(), first, last);
+        found += last - first;
+    }
+
+    sort(ids.begin() + before, ids.end());
+    ids.erase(unique(ids.begin() + before, ids.end()), ids.end());
+
+    return found;
+}
+
+
+size_t MinimizerIndex::bytes() const
+{
+    return _key_offsets.capacity() * sizeof(size_t)
+        + _ids.capacity() * sizeof(int)
+        + _seq_offsets.capacity() * sizeof(size_t)
+        + _seq_keys.capacity() * sizeof(size_t);
+}
+
+}; /* namespace pgraph */
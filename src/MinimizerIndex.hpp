@@ -0,0 +1,98 @@
+/**
+ * @file MinimizerIndex.hpp
+ *
+ * @author agent@local
+ *
+ * Copyright 2026 agent. All rights reserved.
+ *
+ * Inverted index of the (w,k)-minimizers of every sequence of a packed
+ * database. The minimizer of a window of w consecutive k-mers is the
+ * k-mer of smallest hash, so two sequences sharing an exact match of
+ * w+k-1 residues share at least the minimizer of that window. Looking up
+ * the minimizers of one sequence therefore yields a superset of the
+ * sequences it shares such a match with, without building a suffix array.
+ *
+ * k-mers are packed five bits per residue, so k is at most 12 and two
+ * k-mers have the same hash only if they are the same k-mer.
+ */
+#ifndef _PGRAPH_MINIMIZER_INDEX_H_
+#define _PGRAPH_MINIMIZER_INDEX_H_
+
+#include <stdint.h>
+
+#include <cstddef>
+#include <vector>
+
+namespace pgraph {
+
+class MinimizerIndex
+{
+    public:
+        /** Longest k-mer that fits the packed hash. */
+        static const int MAX_K = 12;
+
+        /**
+         * Indexes every sequence of the database.
+         *
+         * @param[in] sequences the packed database
+         * @param[in] BEG first residue of each sequence
+         * @param[in] END sentinal ending each sequence
+         * @param[in] k residues per k-mer, clamped to [1,MAX_K]
+         * @param[in] w k-mers per window, at least 1
+         * @param[in] mask bit per residue; k-mers starting at a set bit
+         *            are never minimizers. May be empty.
+         * @param[in] max_sequences minimizers found in more sequences are
+         *            dropped; 0 keeps them all
+         */
+        MinimizerIndex(const char *sequences,
+                       const std::vector<long> &BEG,
+                       const std::vector<long> &END,
+                       int k, int w,
+                       const std::vector<uint64_t> &mask,
+                       size_t max_sequences=0);
+
+        /**
+         * Appends to ids, sorted and once each, every sequence id above
+         * sid sharing a minimizer with sid. Safe to call concurrently.
+         *
+         * @return the number of ids found before removing duplicates
+         */
+        size_t partners(int sid, std::vector<int> &ids) const;
+
+        int k() const { return _k; }
+        int w() const { return _w; }
+
+        /** Minimizers shared by at least two sequences. */
+        size_t minimizers() const { return _key_offsets.size() - 1; }
+
+        /** (minimizer, sequence) entries kept. */
+        size_t entries() const { return _ids.size(); }
+
+        /** Minimizers dropped as found in over max_sequences sequences. */
+        size_t dropped() const { return _dropped; }
+
+        /** Bytes held by the index. */
+        size_t bytes() const;
+
+    private:
+        /* hashes of the distinct minimizers of residues [beg,end) */
+        void sequence_minimizers(const char *sequences, long beg, long end,
+                                 const std::vector<uint64_t> &mask,
+                                 std::vector<uint64_t> &hashes) const;
+
+        /* not copyable */
+        MinimizerIndex(const MinimizerIndex &);
+        MinimizerIndex& operator=(const MinimizerIndex &);
+
+        int _k;
+        int _w;
+        size_t _dropped;
+        std::vector<size_t> _key_offsets;  /* ids of minimizer m, CSR */
+        std::vector<int> _ids;             /* ascending within a minimizer */
+        std::vector<size_t> _seq_offsets;  /* minimizers of sequence s, CSR */
+        std::vector<size_t> _seq_keys;
+};
+
+}; /* namespace pgraph */
+
+#endif /* _PGRAPH_MINIMIZER_INDEX_H_ */
@@ -0,0 +1,137 @@
+/**
+ * @file PairQueue.hpp
+ *
+ * @author agent@local
+ *
+ * Copyright 2026 agent. All rights reserved.
+ *
+ * Bounded queue of candidate pair batches shared by the OpenMP threads of
+ * a tile, so pairs are aligned while the rest of the tile is traversed.
+ * Batches are moved in and out by swapping vectors, never copied. Push
+ * fails instead of blocking when the queue is full; the producer then
+ * aligns its batch itself, which bounds memory without risking every
+ * thread waiting on the queue.
+ *
+ * Header-only so the OpenMP directives follow the flags of the including
+ * program.
+ */
+#ifndef _PGRAPH_PAIR_QUEUE_H_
+#define _PGRAPH_PAIR_QUEUE_H_
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include <stdint.h>
+
+#include <cstddef>
+#include <deque>
+#include <vector>
+
+namespace pgraph {
+
+class PairQueue
+{
+    public:
+        PairQueue(size_t capacity)
+            : _batches()
+            , _capacity(capacity > 0 ? capacity : 1)
+            , _producers(0)
+            , _depth(0)
+        {
+#ifdef _OPENMP
+            omp_init_lock(&_lock);
+#endif
+        }
+
+        ~PairQueue() {
+#ifdef _OPENMP
+            omp_destroy_lock(&_lock);
+#endif
+        }
+
+        /** Moves batch to the back of the queue and leaves it empty;
+         * returns false, leaving batch alone, if the queue is full. */
+        bool push(std::vector<uint64_t> &batch) {
+            bool pushed = false;
+            lock();
+            if (_batches.size() < _capacity) {
+                _batches.push_back(std::vector<uint64_t>());
+                _batches.back().swap(batch);
+                if (_batches.size() > _depth) {
+                    _depth = _batches.size();
+                }
+                pushed = true;
+            }
+            unlock();
+            return pushed;
+        }
+
+        /** Moves the oldest batch into batch; returns false if empty. */
+        bool pop(std::vector<uint64_t> &batch) {
+            bool popped = false;
+            lock();
+            if (!_batches.empty()) {
+                batch.swap(_batches.front());
+                _batches.pop_front();
+                popped = true;
+            }
+            unlock();
+            return popped;
+        }
+
+        /** A thread is about to produce batches. */
+        void open() {
+            lock();
+            ++_producers;
+            unlock();
+        }
+
+        /** A thread will produce no more batches. */
+        void close() {
+            lock();
+            --_producers;
+            unlock();
+        }
+
+        /** True once no thread is producing and every batch was popped. */
+        bool drained() {
+            bool result;
+            lock();
+            result = 0 == _producers && _batches.empty();
+            unlock();
+            return result;
+        }
+
+        /** Most batches the queue has held at once. */
+        size_t depth() const { return _depth; }
+
+    private:
+        void lock() {
+#ifdef _OPENMP
+            omp_set_lock(&_lock);
+#endif
+        }
+
+        void unlock() {
+#ifdef _OPENMP
+            omp_unset_lock(&_lock);
+#endif
+        }
+
+        /* not copyable */
+        PairQueue(const PairQueue &);
+        PairQueue& operator=(const PairQueue &);
+
+        std::deque<std::vector<uint64_t> > _batches;
+        size_t _capacity;
+        int _producers;
+        size_t _depth;
+#ifdef _OPENMP
+        omp_lock_t _lock;
+#endif
+};
+
+}; /* namespace pgraph */
+
+#endif /* _PGRAPH_PAIR_QUEUE_H_ */
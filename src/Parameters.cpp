@@ -11,6 +11,7 @@
 #include <mpi.h>
 
 #include <cassert>
+#include <climits>
 #include <fstream>
 #include <iostream>
 #include <map>
@@ -71,6 +72,38 @@ const string Parameters::KEY_DUPLICATES_GLOBAL("DuplicatesGlobal");
 const string Parameters::KEY_BUCKET_CUTOFF("BucketCutoff");
 const string Parameters::KEY_SKIP_TREE("SkipTree");
 const string Parameters::KEY_PERFORM_ALIGNMENTS("PerformAlignments");
+const string Parameters::KEY_NXTVAL_GUIDED("NxtvalGuided");
+const string Parameters::KEY_NXTVAL_CHUNK_MIN("NxtvalChunkMin");
+const string Parameters::KEY_NXTVAL_RMA("NxtvalRma");
+const string Parameters::KEY_TILE_ORDER_LPT("TileOrderLPT");
+const string Parameters::KEY_TILE_COST_SAMPLES("TileCostSamples");
+const string Parameters::KEY_PIPELINE_TILES("PipelineTiles");
+const string Parameters::KEY_SA_PARALLEL("SuffixArrayParallel");
+const string Parameters::KEY_SA_BLOCK_CACHE("SuffixArrayBlockCache");
+const string Parameters::KEY_TILE_PREFILTER("TilePrefilter");
+const string Parameters::KEY_TILE_PREFILTER_BITS("TilePrefilterBits");
+const string Parameters::KEY_WORKSPACE_HUGE_PAGES("WorkspaceHugePages");
+const string Parameters::KEY_SA_WIDE_RESIDUES("SuffixArrayWideResidues");
+const string Parameters::KEY_SA_BLOCK_BUDGET("SuffixArrayBlockBudget");
+const string Parameters::KEY_PAIR_STEAL_THRESHOLD("PairStealThreshold");
+const string Parameters::KEY_PAIR_STREAM("PairStream");
+const string Parameters::KEY_PAIR_BATCH_SIZE("PairBatchSize");
+const string Parameters::KEY_PAIR_QUEUE_DEPTH("PairQueueDepth");
+const string Parameters::KEY_MASK_LOW_COMPLEXITY("MaskLowComplexity");
+const string Parameters::KEY_MASK_WINDOW("MaskWindow");
+const string Parameters::KEY_MASK_ENTROPY("MaskEntropy");
+const string Parameters::KEY_HEAVY_INTERVAL_WIDTH("HeavyIntervalWidth");
+const string Parameters::KEY_SA_SPARSE_STEP("SuffixArraySparseStep");
+const string Parameters::KEY_SA_SPARSE_VERIFY("SuffixArraySparseVerify");
+const string Parameters::KEY_FILTER_ENGINE("FilterEngine");
+const string Parameters::KEY_MINIMIZER_K("MinimizerK");
+const string Parameters::KEY_MINIMIZER_WINDOW("MinimizerWindow");
+const string Parameters::KEY_MINIMIZER_MAX_SEQUENCES("MinimizerMaxSequences");
+const string Parameters::KEY_FM_INDEX_SAMPLE("FMIndexSample");
+const string Parameters::KEY_REUSE_QUERY_PROFILE("ReuseQueryProfile");
+const string Parameters::KEY_ALIGN_SCREEN("AlignScreen");
+const string Parameters::KEY_SCREEN_FUNCTION("ScreenFunction");
+const string Parameters::KEY_BAND_WIDTH("BandWidth");
 /* Defaults */
 const int Parameters::DEF_ALIGN_OVER_LONGER_SEQUENCE(80);
 const int Parameters::DEF_MATCH_SIMILARITY(40);
@@ -106,6 +139,38 @@ const bool Parameters::DEF_DUPLICATES_GLOBAL(false);
 const size_t Parameters::DEF_BUCKET_CUTOFF(30);
 const bool Parameters::DEF_SKIP_TREE(false);
 const bool Parameters::DEF_PERFORM_ALIGNMENTS(true);
+const bool Parameters::DEF_NXTVAL_GUIDED(false);
+const int Parameters::DEF_NXTVAL_CHUNK_MIN(1);
+const bool Parameters::DEF_NXTVAL_RMA(false);
+const bool Parameters::DEF_TILE_ORDER_LPT(false);
+const int Parameters::DEF_TILE_COST_SAMPLES(0);
+const bool Parameters::DEF_PIPELINE_TILES(false);
+const bool Parameters::DEF_SA_PARALLEL(false);
+const int Parameters::DEF_SA_BLOCK_CACHE(0);
+const bool Parameters::DEF_TILE_PREFILTER(false);
+const int Parameters::DEF_TILE_PREFILTER_BITS(20);
+const bool Parameters::DEF_WORKSPACE_HUGE_PAGES(true);
+const int Parameters::DEF_SA_WIDE_RESIDUES(INT_MAX);
+const bool Parameters::DEF_SA_BLOCK_BUDGET(false);
+const int Parameters::DEF_PAIR_STEAL_THRESHOLD(0);
+const bool Parameters::DEF_PAIR_STREAM(false);
+const int Parameters::DEF_PAIR_BATCH_SIZE(4096);
+const int Parameters::DEF_PAIR_QUEUE_DEPTH(0);
+const bool Parameters::DEF_MASK_LOW_COMPLEXITY(false);
+const int Parameters::DEF_MASK_WINDOW(12);
+const double Parameters::DEF_MASK_ENTROPY(2.2);
+const int Parameters::DEF_HEAVY_INTERVAL_WIDTH(0);
+const int Parameters::DEF_SA_SPARSE_STEP(1);
+const bool Parameters::DEF_SA_SPARSE_VERIFY(false);
+const string Parameters::DEF_FILTER_ENGINE("esa");
+const int Parameters::DEF_MINIMIZER_K(0);
+const int Parameters::DEF_MINIMIZER_WINDOW(0);
+const int Parameters::DEF_MINIMIZER_MAX_SEQUENCES(0);
+const int Parameters::DEF_FM_INDEX_SAMPLE(32);
+const bool Parameters::DEF_REUSE_QUERY_PROFILE(true);
+const bool Parameters::DEF_ALIGN_SCREEN(true);
+const string Parameters::DEF_SCREEN_FUNCTION("");
+const int Parameters::DEF_BAND_WIDTH(0);
 
 
 static size_t parse_memory_budget(const string& value)
@@ -201,6 +266,38 @@ Parameters::Parameters()
     , bucket_cutoff(DEF_BUCKET_CUTOFF)
     , skip_tree(DEF_SKIP_TREE)
     , perform_alignments(DEF_PERFORM_ALIGNMENTS)
+    , nxtval_guided(DEF_NXTVAL_GUIDED)
+    , nxtval_chunk_min(DEF_NXTVAL_CHUNK_MIN)
+    , nxtval_rma(DEF_NXTVAL_RMA)
+    , tile_order_lpt(DEF_TILE_ORDER_LPT)
+    , tile_cost_samples(DEF_TILE_COST_SAMPLES)
+    , pipeline_tiles(DEF_PIPELINE_TILES)
+    , sa_parallel(DEF_SA_PARALLEL)
+    , sa_block_cache(DEF_SA_BLOCK_CACHE)
+    , tile_prefilter(DEF_TILE_PREFILTER)
+    , tile_prefilter_bits(DEF_TILE_PREFILTER_BITS)
+    , workspace_huge_pages(DEF_WORKSPACE_HUGE_PAGES)
+    , sa_wide_residues(DEF_SA_WIDE_RESIDUES)
+    , sa_block_budget(DEF_SA_BLOCK_BUDGET)
+    , pair_steal_threshold(DEF_PAIR_STEAL_THRESHOLD)
+    , pair_stream(DEF_PAIR_STREAM)
+    , pair_batch_size(DEF_PAIR_BATCH_SIZE)
+    , pair_queue_depth(DEF_PAIR_QUEUE_DEPTH)
+    , mask_low_complexity(DEF_MASK_LOW_COMPLEXITY)
+    , mask_window(DEF_MASK_WINDOW)
+    , mask_entropy(DEF_MASK_ENTROPY)
+    , heavy_interval_width(DEF_HEAVY_INTERVAL_WIDTH)
+    , sa_sparse_step(DEF_SA_SPARSE_STEP)
+    , sa_sparse_verify(DEF_SA_SPARSE_VERIFY)
+    , filter_engine(DEF_FILTER_ENGINE)
+    , minimizer_k(DEF_MINIMIZER_K)
+    , minimizer_window(DEF_MINIMIZER_WINDOW)
+    , minimizer_max_sequences(DEF_MINIMIZER_MAX_SEQUENCES)
+    , fm_index_sample(DEF_FM_INDEX_SAMPLE)
+    , reuse_query_profile(DEF_REUSE_QUERY_PROFILE)
+    , align_screen(DEF_ALIGN_SCREEN)
+    , screen_function(DEF_SCREEN_FUNCTION)
+    , band_width(DEF_BAND_WIDTH)
 {
 }
 
@@ -241,6 +338,38 @@ Parameters::Parameters(const char *parameters_file, MPI_Comm comm)
     , bucket_cutoff(DEF_BUCKET_CUTOFF)
     , skip_tree(DEF_SKIP_TREE)
     , perform_alignments(DEF_PERFORM_ALIGNMENTS)
+    , nxtval_guided(DEF_NXTVAL_GUIDED)
+    , nxtval_chunk_min(DEF_NXTVAL_CHUNK_MIN)
+    , nxtval_rma(DEF_NXTVAL_RMA)
+    , tile_order_lpt(DEF_TILE_ORDER_LPT)
+    , tile_cost_samples(DEF_TILE_COST_SAMPLES)
+    , pipeline_tiles(DEF_PIPELINE_TILES)
+    , sa_parallel(DEF_SA_PARALLEL)
+    , sa_block_cache(DEF_SA_BLOCK_CACHE)
+    , tile_prefilter(DEF_TILE_PREFILTER)
+    , tile_prefilter_bits(DEF_TILE_PREFILTER_BITS)
+    , workspace_huge_pages(DEF_WORKSPACE_HUGE_PAGES)
+    , sa_wide_residues(DEF_SA_WIDE_RESIDUES)
+    , sa_block_budget(DEF_SA_BLOCK_BUDGET)
+    , pair_steal_threshold(DEF_PAIR_STEAL_THRESHOLD)
+    , pair_stream(DEF_PAIR_STREAM)
+    , pair_batch_size(DEF_PAIR_BATCH_SIZE)
+    , pair_queue_depth(DEF_PAIR_QUEUE_DEPTH)
+    , mask_low_complexity(DEF_MASK_LOW_COMPLEXITY)
+    , mask_window(DEF_MASK_WINDOW)
+    , mask_entropy(DEF_MASK_ENTROPY)
+    , heavy_interval_width(DEF_HEAVY_INTERVAL_WIDTH)
+    , sa_sparse_step(DEF_SA_SPARSE_STEP)
+    , sa_sparse_verify(DEF_SA_SPARSE_VERIFY)
+    , filter_engine(DEF_FILTER_ENGINE)
+    , minimizer_k(DEF_MINIMIZER_K)
+    , minimizer_window(DEF_MINIMIZER_WINDOW)
+    , minimizer_max_sequences(DEF_MINIMIZER_MAX_SEQUENCES)
+    , fm_index_sample(DEF_FM_INDEX_SAMPLE)
+    , reuse_query_profile(DEF_REUSE_QUERY_PROFILE)
+    , align_screen(DEF_ALIGN_SCREEN)
+    , screen_function(DEF_SCREEN_FUNCTION)
+    , band_width(DEF_BAND_WIDTH)
 {
     parse(parameters_file, comm);
 }
@@ -325,6 +454,70 @@ void Parameters::parse(const char *parameters_file, MPI_Comm comm)
                 DEF_SKIP_TREE);
         perform_alignments = config[KEY_PERFORM_ALIGNMENTS].as<bool>(
                 DEF_PERFORM_ALIGNMENTS);
+        nxtval_guided = config[KEY_NXTVAL_GUIDED].as<bool>(
+                DEF_NXTVAL_GUIDED);
+        nxtval_chunk_min = config[KEY_NXTVAL_CHUNK_MIN].as<int>(
+                DEF_NXTVAL_CHUNK_MIN);
+        nxtval_rma = config[KEY_NXTVAL_RMA].as<bool>(
+                DEF_NXTVAL_RMA);
+        tile_order_lpt = config[KEY_TILE_ORDER_LPT].as<bool>(
+                DEF_TILE_ORDER_LPT);
+        tile_cost_samples = config[KEY_TILE_COST_SAMPLES].as<int>(
+                DEF_TILE_COST_SAMPLES);
+        pipeline_tiles = config[KEY_PIPELINE_TILES].as<bool>(
+                DEF_PIPELINE_TILES);
+        sa_parallel = config[KEY_SA_PARALLEL].as<bool>(
+                DEF_SA_PARALLEL);
+        sa_block_cache = config[KEY_SA_BLOCK_CACHE].as<int>(
+                DEF_SA_BLOCK_CACHE);
+        tile_prefilter = config[KEY_TILE_PREFILTER].as<bool>(
+                DEF_TILE_PREFILTER);
+        tile_prefilter_bits = config[KEY_TILE_PREFILTER_BITS].as<int>(
+                DEF_TILE_PREFILTER_BITS);
+        workspace_huge_pages = config[KEY_WORKSPACE_HUGE_PAGES].as<bool>(
+                DEF_WORKSPACE_HUGE_PAGES);
+        sa_wide_residues = config[KEY_SA_WIDE_RESIDUES].as<int>(
+                DEF_SA_WIDE_RESIDUES);
+        sa_block_budget = config[KEY_SA_BLOCK_BUDGET].as<bool>(
+                DEF_SA_BLOCK_BUDGET);
+        pair_steal_threshold = config[KEY_PAIR_STEAL_THRESHOLD].as<int>(
+                DEF_PAIR_STEAL_THRESHOLD);
+        pair_stream = config[KEY_PAIR_STREAM].as<bool>(
+                DEF_PAIR_STREAM);
+        pair_batch_size = config[KEY_PAIR_BATCH_SIZE].as<int>(
+                DEF_PAIR_BATCH_SIZE);
+        pair_queue_depth = config[KEY_PAIR_QUEUE_DEPTH].as<int>(
+                DEF_PAIR_QUEUE_DEPTH);
+        mask_low_complexity = config[KEY_MASK_LOW_COMPLEXITY].as<bool>(
+                DEF_MASK_LOW_COMPLEXITY);
+        mask_window = config[KEY_MASK_WINDOW].as<int>(
+                DEF_MASK_WINDOW);
+        mask_entropy = config[KEY_MASK_ENTROPY].as<double>(
+                DEF_MASK_ENTROPY);
+        heavy_interval_width = config[KEY_HEAVY_INTERVAL_WIDTH].as<int>(
+                DEF_HEAVY_INTERVAL_WIDTH);
+        sa_sparse_step = config[KEY_SA_SPARSE_STEP].as<int>(
+                DEF_SA_SPARSE_STEP);
+        sa_sparse_verify = config[KEY_SA_SPARSE_VERIFY].as<bool>(
+                DEF_SA_SPARSE_VERIFY);
+        filter_engine = config[KEY_FILTER_ENGINE].as<string>(
+                DEF_FILTER_ENGINE);
+        minimizer_k = config[KEY_MINIMIZER_K].as<int>(
+                DEF_MINIMIZER_K);
+        minimizer_window = config[KEY_MINIMIZER_WINDOW].as<int>(
+                DEF_MINIMIZER_WINDOW);
+        minimizer_max_sequences = config[KEY_MINIMIZER_MAX_SEQUENCES].as<int>(
+                DEF_MINIMIZER_MAX_SEQUENCES);
+        fm_index_sample = config[KEY_FM_INDEX_SAMPLE].as<int>(
+                DEF_FM_INDEX_SAMPLE);
+        reuse_query_profile = config[KEY_REUSE_QUERY_PROFILE].as<bool>(
+                DEF_REUSE_QUERY_PROFILE);
+        align_screen = config[KEY_ALIGN_SCREEN].as<bool>(
+                DEF_ALIGN_SCREEN);
+        screen_function = config[KEY_SCREEN_FUNCTION].as<string>(
+                DEF_SCREEN_FUNCTION);
+        band_width = config[KEY_BAND_WIDTH].as<int>(
+                DEF_BAND_WIDTH);
 
         string val;
         val = config[KEY_MEMORY_WORKER].as<string>("");
@@ -401,6 +594,38 @@ ostream& operator<< (ostream &os, const Parameters &p)
     out << YAML::Key << Parameters::KEY_BUCKET_CUTOFF << YAML::Value << p.bucket_cutoff;
     out << YAML::Key << Parameters::KEY_SKIP_TREE << YAML::Value << p.skip_tree;
     out << YAML::Key << Parameters::KEY_PERFORM_ALIGNMENTS << YAML::Value << p.perform_alignments;
+    out << YAML::Key << Parameters::KEY_NXTVAL_GUIDED << YAML::Value << p.nxtval_guided;
+    out << YAML::Key << Parameters::KEY_NXTVAL_CHUNK_MIN << YAML::Value << p.nxtval_chunk_min;
+    out << YAML::Key << Parameters::KEY_NXTVAL_RMA << YAML::Value << p.nxtval_rma;
+    out << YAML::Key << Parameters::KEY_TILE_ORDER_LPT << YAML::Value << p.tile_order_lpt;
+    out << YAML::Key << Parameters::KEY_TILE_COST_SAMPLES << YAML::Value << p.tile_cost_samples;
+    out << YAML::Key << Parameters::KEY_PIPELINE_TILES << YAML::Value << p.pipeline_tiles;
+    out << YAML::Key << Parameters::KEY_SA_PARALLEL << YAML::Value << p.sa_parallel;
+    out << YAML::Key << Parameters::KEY_SA_BLOCK_CACHE << YAML::Value << p.sa_block_cache;
+    out << YAML::Key << Parameters::KEY_TILE_PREFILTER << YAML::Value << p.tile_prefilter;
+    out << YAML::Key << Parameters::KEY_TILE_PREFILTER_BITS << YAML::Value << p.tile_prefilter_bits;
+    out << YAML::Key << Parameters::KEY_WORKSPACE_HUGE_PAGES << YAML::Value << p.workspace_huge_pages;
+    out << YAML::Key << Parameters::KEY_SA_WIDE_RESIDUES << YAML::Value << p.sa_wide_residues;
+    out << YAML::Key << Parameters::KEY_SA_BLOCK_BUDGET << YAML::Value << p.sa_block_budget;
+    out << YAML::Key << Parameters::KEY_PAIR_STEAL_THRESHOLD << YAML::Value << p.pair_steal_threshold;
+    out << YAML::Key << Parameters::KEY_PAIR_STREAM << YAML::Value << p.pair_stream;
+    out << YAML::Key << Parameters::KEY_PAIR_BATCH_SIZE << YAML::Value << p.pair_batch_size;
+    out << YAML::Key << Parameters::KEY_PAIR_QUEUE_DEPTH << YAML::Value << p.pair_queue_depth;
+    out << YAML::Key << Parameters::KEY_MASK_LOW_COMPLEXITY << YAML::Value << p.mask_low_complexity;
+    out << YAML::Key << Parameters::KEY_MASK_WINDOW << YAML::Value << p.mask_window;
+    out << YAML::Key << Parameters::KEY_MASK_ENTROPY << YAML::Value << p.mask_entropy;
+    out << YAML::Key << Parameters::KEY_HEAVY_INTERVAL_WIDTH << YAML::Value << p.heavy_interval_width;
+    out << YAML::Key << Parameters::KEY_SA_SPARSE_STEP << YAML::Value << p.sa_sparse_step;
+    out << YAML::Key << Parameters::KEY_SA_SPARSE_VERIFY << YAML::Value << p.sa_sparse_verify;
+    out << YAML::Key << Parameters::KEY_FILTER_ENGINE << YAML::Value << p.filter_engine;
+    out << YAML::Key << Parameters::KEY_MINIMIZER_K << YAML::Value << p.minimizer_k;
+    out << YAML::Key << Parameters::KEY_MINIMIZER_WINDOW << YAML::Value << p.minimizer_window;
+    out << YAML::Key << Parameters::KEY_MINIMIZER_MAX_SEQUENCES << YAML::Value << p.minimizer_max_sequences;
+    out << YAML::Key << Parameters::KEY_FM_INDEX_SAMPLE << YAML::Value << p.fm_index_sample;
+    out << YAML::Key << Parameters::KEY_REUSE_QUERY_PROFILE << YAML::Value << p.reuse_query_profile;
+    out << YAML::Key << Parameters::KEY_ALIGN_SCREEN << YAML::Value << p.align_screen;
+    out << YAML::Key << Parameters::KEY_SCREEN_FUNCTION << YAML::Value << p.screen_function;
+    out << YAML::Key << Parameters::KEY_BAND_WIDTH << YAML::Value << p.band_width;
     out << YAML::EndMap;
     os << out.c_str();
     return os;
@@ -66,6 +66,38 @@ public:
     static const string KEY_BUCKET_CUTOFF;
     static const string KEY_SKIP_TREE;
     static const string KEY_PERFORM_ALIGNMENTS;
+    static const string KEY_NXTVAL_GUIDED;
+    static const string KEY_NXTVAL_CHUNK_MIN;
+    static const string KEY_NXTVAL_RMA;
+    static const string KEY_TILE_ORDER_LPT;
+    static const string KEY_TILE_COST_SAMPLES;
+    static const string KEY_PIPELINE_TILES;
+    static const string KEY_SA_PARALLEL;
+    static const string KEY_SA_BLOCK_CACHE;
+    static const string KEY_TILE_PREFILTER;
+    static const string KEY_TILE_PREFILTER_BITS;
+    static const string KEY_WORKSPACE_HUGE_PAGES;
+    static const string KEY_SA_WIDE_RESIDUES;
+    static const string KEY_SA_BLOCK_BUDGET;
+    static const string KEY_PAIR_STEAL_THRESHOLD;
+    static const string KEY_PAIR_STREAM;
+    static const string KEY_PAIR_BATCH_SIZE;
+    static const string KEY_PAIR_QUEUE_DEPTH;
+    static const string KEY_MASK_LOW_COMPLEXITY;
+    static const string KEY_MASK_WINDOW;
+    static const string KEY_MASK_ENTROPY;
+    static const string KEY_HEAVY_INTERVAL_WIDTH;
+    static const string KEY_SA_SPARSE_STEP;
+    static const string KEY_SA_SPARSE_VERIFY;
+    static const string KEY_FILTER_ENGINE;
+    static const string KEY_MINIMIZER_K;
+    static const string KEY_MINIMIZER_WINDOW;
+    static const string KEY_MINIMIZER_MAX_SEQUENCES;
+    static const string KEY_FM_INDEX_SAMPLE;
+    static const string KEY_REUSE_QUERY_PROFILE;
+    static const string KEY_ALIGN_SCREEN;
+    static const string KEY_SCREEN_FUNCTION;
+    static const string KEY_BAND_WIDTH;
 
     /* Defaults */
     static const int DEF_ALIGN_OVER_LONGER_SEQUENCE;
@@ -102,6 +134,38 @@ public:
     static const size_t DEF_BUCKET_CUTOFF;
     static const bool DEF_SKIP_TREE;
     static const bool DEF_PERFORM_ALIGNMENTS;
+    static const bool DEF_NXTVAL_GUIDED;
+    static const int DEF_NXTVAL_CHUNK_MIN;
+    static const bool DEF_NXTVAL_RMA;
+    static const bool DEF_TILE_ORDER_LPT;
+    static const int DEF_TILE_COST_SAMPLES;
+    static const bool DEF_PIPELINE_TILES;
+    static const bool DEF_SA_PARALLEL;
+    static const int DEF_SA_BLOCK_CACHE;
+    static const bool DEF_TILE_PREFILTER;
+    static const int DEF_TILE_PREFILTER_BITS;
+    static const bool DEF_WORKSPACE_HUGE_PAGES;
+    static const int DEF_SA_WIDE_RESIDUES;
+    static const bool DEF_SA_BLOCK_BUDGET;
+    static const int DEF_PAIR_STEAL_THRESHOLD;
+    static const bool DEF_PAIR_STREAM;
+    static const int DEF_PAIR_BATCH_SIZE;
+    static const int DEF_PAIR_QUEUE_DEPTH;
+    static const bool DEF_MASK_LOW_COMPLEXITY;
+    static const int DEF_MASK_WINDOW;
+    static const double DEF_MASK_ENTROPY;
+    static const int DEF_HEAVY_INTERVAL_WIDTH;
+    static const int DEF_SA_SPARSE_STEP;
+    static const bool DEF_SA_SPARSE_VERIFY;
+    static const string DEF_FILTER_ENGINE;
+    static const int DEF_MINIMIZER_K;
+    static const int DEF_MINIMIZER_WINDOW;
+    static const int DEF_MINIMIZER_MAX_SEQUENCES;
+    static const int DEF_FM_INDEX_SAMPLE;
+    static const bool DEF_REUSE_QUERY_PROFILE;
+    static const bool DEF_ALIGN_SCREEN;
+    static const string DEF_SCREEN_FUNCTION;
+    static const int DEF_BAND_WIDTH;
 
     /**
      * Constructs empty (default) parameters.
@@ -168,6 +232,38 @@ public:
     size_t bucket_cutoff; /**< how many stddev above bucket size to discard */
     bool skip_tree;     /**< don't use tree if cutoff == exact match length */
     bool perform_alignments; /**< when debugging, sometimes useful to not align */
+    bool nxtval_guided; /**< whether NXTVAL hands out guided chunks of tiles */
+    int nxtval_chunk_min; /**< smallest guided NXTVAL chunk */
+    bool nxtval_rma; /**< whether NXTVAL uses an MPI-3 RMA window instead of a server */
+    bool tile_order_lpt; /**< whether tiles are served largest predicted cost first */
+    int tile_cost_samples; /**< sequences per block sampled for candidate density */
+    bool pipeline_tiles; /**< whether the next tile's ESA is built while the current tile aligns */
+    bool sa_parallel; /**< whether tile suffix arrays are built with the OpenMP sais_omp on all threads; off-diagonal tiles always use sais_omp, otherwise on one */
+    int sa_block_cache; /**< block suffix arrays kept for merging into later tiles, 0 disables */
+    bool tile_prefilter; /**< whether tiles whose blocks share no k-mer are skipped */
+    int tile_prefilter_bits; /**< log2 of the k-mer signature size in bits per block */
+    bool workspace_huge_pages; /**< whether large tile scratch buffers are advised to use transparent huge pages */
+    int sa_wide_residues; /**< tiles of at least this many residues use 64-bit suffix arrays */
+    bool sa_block_budget; /**< whether blocks are sized by residues so every tile fits in MemoryWorker bytes, half of which bounds the pair buffers */
+    int pair_steal_threshold; /**< ranks out of tiles steal from tiles with more pairs left than this, 0 disables */
+    bool pair_stream; /**< whether a tile's pairs are aligned in batches while its ESA is traversed */
+    int pair_batch_size; /**< unique pairs per batch when streaming pairs */
+    int pair_queue_depth; /**< batches the pair queue holds when streaming, 0 for 4 per thread */
+    bool mask_low_complexity; /**< whether low-complexity regions are excluded as seed starts */
+    int mask_window; /**< residues per window of the low-complexity mask */
+    double mask_entropy; /**< windows with less Shannon entropy, in bits, are masked */
+    int heavy_interval_width; /**< l-intervals, or FM index windows, with more suffixes emit pairs per distinct sequence, 0 disables */
+    int sa_sparse_step; /**< off-diagonal tiles sort and index only every this many suffixes of their larger block, 1 indexes all */
+    bool sa_sparse_verify; /**< whether sparse tiles are also filtered in full to compare their candidate pairs */
+    string filter_engine; /**< candidate pair engine, esa, minimizer or fmindex */
+    int minimizer_k; /**< k-mer length of minimizers, 0 to derive from ExactMatchLength */
+    int minimizer_window; /**< k-mers per minimizer window, 0 so any exact match shares one */
+    int minimizer_max_sequences; /**< drop minimizers found in more sequences, 0 keeps all */
+    int fm_index_sample; /**< FM-index keeps the position of every this many residues */
+    bool reuse_query_profile; /**< whether each thread aligns all partners of a sequence against one query profile */
+    bool align_screen; /**< whether a score-only alignment rejects pairs below the self score threshold first */
+    string screen_function; /**< score-only parasail function of the screen, empty to derive it from Function */
+    int band_width; /**< cells this far off the seed diagonal of a long pair are aligned first, 0 aligns every pair in full; approximate, as an edge may report another alignment of the same optimal score */
 };
 
 ostream& operator<< (ostream &os, const Parameters &p);
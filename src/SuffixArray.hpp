@@ -40,22 +40,40 @@ using ::std::size_t;
 
 namespace pgraph {
 
+/**
+ * boundaries of a child l-interval
+ */
+struct interval {
+    int lb;
+    int rb;
+
+    interval(int lb, int rb)
+        : lb(lb), rb(rb) {}
+};
+
+/**
+ * an l-interval on the bottom-up traversal stack
+ *
+ * Its children are kept on a separate stack of intervals, starting at
+ * index 'children'. Intervals pushed after this one are popped first and
+ * drop their own children, so the rest of the child stack is ours.
+ */
 struct quad {
     int lcp;
     int lb;
     int rb;
-    vector<quad> children;
+    int children;
 
     quad()
-        : lcp(0), lb(0), rb(INT_MAX), children() {}
-    quad(int lcp, int lb, int rb)
-        : lcp(lcp), lb(lb), rb(rb), children() {}
-    quad(int lcp, int lb, int rb, vector<quad> children)
+        : lcp(0), lb(0), rb(INT_MAX), children(0) {}
+    quad(int lcp, int lb, int rb, int children)
         : lcp(lcp), lb(lb), rb(rb), children(children) {}
 
     bool empty() { return rb == INT_MAX; }
 };
 
+typedef vector<interval> ChildStack;
+
 typedef void(*SuffixArrayPairCallback)(Pair);
 
 
@@ -150,6 +168,7 @@ class SuffixArray
                 int &count_generated,
                 Callback callback,
                 const quad &q,
+                const ChildStack &children,
                 const int &cutoff);
 
         Sequence& get_sequence(size_t i) {
@@ -359,7 +378,8 @@ bool SuffixArray::generate_pairs(Callback callback)
             SA[new_bup_stop+2], T[SA[new_bup_stop+2]]);
 #endif
 
-    stack<quad> the_stack;
+    stack<quad, vector<quad> > the_stack;
+    ChildStack children;
     quad last_interval;
     the_stack.push(quad());
     for (int i = new_bup_start; i <= new_bup_stop; ++i) {
@@ -368,27 +388,24 @@ bool SuffixArray::generate_pairs(Callback callback)
             the_stack.top().rb = i - 1;
             last_interval = the_stack.top();
             the_stack.pop();
-            process(count, count_generated, callback, last_interval, cutoff);
+            process(count, count_generated, callback, last_interval, children, cutoff);
+            children.resize(last_interval.children, interval(0,0));
             lb = last_interval.lb;
             if (LCP[i] <= the_stack.top().lcp) {
-                last_interval.children.clear();
-                the_stack.top().children.push_back(last_interval);
+                children.push_back(interval(last_interval.lb, last_interval.rb));
                 last_interval = quad();
             }
         }
         if (LCP[i] > the_stack.top().lcp) {
+            the_stack.push(quad(LCP[i],lb,INT_MAX,children.size()));
             if (!last_interval.empty()) {
-                last_interval.children.clear();
-                the_stack.push(quad(LCP[i],lb,INT_MAX,vector<quad>(1, last_interval)));
+                children.push_back(interval(last_interval.lb, last_interval.rb));
                 last_interval = quad();
             }
-            else {
-                the_stack.push(quad(LCP[i],lb,INT_MAX));
-            }
         }
     }
     the_stack.top().rb = bup_stop - 1;
-    process(count, count_generated, callback, the_stack.top(), cutoff);
+    process(count, count_generated, callback, the_stack.top(), children, cutoff);
 
     return false;
 }
@@ -425,23 +442,24 @@ bool SuffixArray::process(
         int &count_generated,
         Callback callback,
         const quad &q,
+        const ChildStack &children,
         const int &cutoff)
 {
     bool retval = false;
-    const int n_children = q.children.size();
-    int child_index = 0;
+    const int n_children = children.size();
+    int child_index = q.children;
 
     ++count;
 
     if (q.lcp < cutoff) return false;
 
-    if (n_children) {
+    if (n_children > child_index) {
         for (int i=q.lb; i<=q.rb; ++i) {
             int j = i+1;
             if (child_index < n_children) {
-                if (i >= q.children[child_index].lb) {
-                    j = q.children[child_index].rb+1;
-                    if (i >= q.children[child_index].rb) {
+                if (i >= children[child_index].lb) {
+                    j = children[child_index].rb+1;
+                    if (i >= children[child_index].rb) {
                         ++child_index;
                     }
                 }
@@ -26,8 +26,25 @@ class SuffixArrayStats
         unsigned long arrays;
         Stats suffixes;
         Stats pairs;
+        Stats unique;       /**< distinct candidate pairs of each array */
         Stats time_build;
         Stats time_process;
+        Stats time_overlap; /**< ESA build hidden behind alignment */
+        Stats time_wait;    /**< thread-seconds idle per tile */
+        unsigned long skipped;  /**< tiles whose blocks share no k-mer */
+        Stats time_skipped; /**< estimated seconds saved per skipped tile */
+        Stats faults;       /**< page faults while filtering a tile */
+        unsigned long workspace; /**< peak bytes of tile scratch buffers */
+        unsigned long wide; /**< arrays built with 64-bit indices */
+        Stats bytes;        /**< peak ESA bytes per residue of each tile, scratch included */
+        Stats queue;        /**< deepest pair queue of each streamed tile */
+        Stats time_stall;   /**< thread-seconds waiting on an empty queue */
+        unsigned long full; /**< batches aligned by a producer, queue full */
+        Stats masked;       /**< pairs of each array seeded only when masked */
+        Stats heavy;        /**< guarded l-intervals of each array */
+        unsigned long sparse;  /**< arrays of sampled suffixes */
+        unsigned long missing; /**< verified pairs the sparse arrays missed */
+        unsigned long extra;   /**< verified pairs only the sparse arrays found */
         double time_first;
         double time_last;
 
@@ -35,8 +52,25 @@ class SuffixArrayStats
             : arrays(0U)
             , suffixes()
             , pairs()
+            , unique()
             , time_build()
             , time_process()
+            , time_overlap()
+            , time_wait()
+            , skipped(0U)
+            , time_skipped()
+            , faults()
+            , workspace(0U)
+            , wide(0U)
+            , bytes()
+            , queue()
+            , time_stall()
+            , full(0U)
+            , masked()
+            , heavy()
+            , sparse(0U)
+            , missing(0U)
+            , extra(0U)
             , time_first(0.0)
             , time_last(0.0)
         { }
@@ -46,8 +80,25 @@ class SuffixArrayStats
                 "        Arrays"
                 "      Suffixes"
                 "         Pairs"
+                "        Unique"
                 "    Time_Build"
                 "  Time_Process"
+                "  Time_Overlap"
+                "     Time_Wait"
+                "       Skipped"
+                "  Time_Skipped"
+                "        Faults"
+                "     Workspace"
+                "          Wide"
+                "         Bytes"
+                "         Queue"
+                "    Time_Stall"
+                "          Full"
+                "        Masked"
+                "         Heavy"
+                "        Sparse"
+                "       Missing"
+                "         Extra"
                 "    Time_First"
                 "    Time_Last"
                 ;
@@ -56,22 +107,56 @@ class SuffixArrayStats
         friend ostream &operator << (ostream &os, const SuffixArrayStats &stats) {
             os << setw(19) << right << "Suffixes" << stats.suffixes << endl;
             os << setw(19) << right << "Pairs" << stats.pairs << endl;
+            os << setw(19) << right << "UniquePairs" << stats.unique << endl;
             os << setw(19) << right << "TimeBuild" << stats.time_build << endl;
             os << setw(19) << right << "TimeProcess" << stats.time_process << endl;
+            os << setw(19) << right << "TimeOverlap" << stats.time_overlap << endl;
+            os << setw(19) << right << "TimeWait" << stats.time_wait << endl;
+            os << setw(19) << right << "TimeSkipped" << stats.time_skipped << endl;
+            os << setw(19) << right << "Faults" << stats.faults << endl;
+            os << setw(19) << right << "BytesPerResidue" << stats.bytes << endl;
+            os << setw(19) << right << "QueueDepth" << stats.queue << endl;
+            os << setw(19) << right << "TimeStall" << stats.time_stall << endl;
+            os << setw(19) << right << "MaskedPairs" << stats.masked << endl;
+            os << setw(19) << right << "HeavyIntervals" << stats.heavy << endl;
             os << setw(19) << right << "Arrays" << setw(Stats::width()) << stats.arrays << endl;
+            os << setw(19) << right << "Skipped" << setw(Stats::width()) << stats.skipped << endl;
+            os << setw(19) << right << "Workspace" << setw(Stats::width()) << stats.workspace << endl;
+            os << setw(19) << right << "Wide" << setw(Stats::width()) << stats.wide << endl;
+            os << setw(19) << right << "QueueFull" << setw(Stats::width()) << stats.full << endl;
+            os << setw(19) << right << "Sparse" << setw(Stats::width()) << stats.sparse << endl;
+            os << setw(19) << right << "SparseMissing" << setw(Stats::width()) << stats.missing << endl;
+            os << setw(19) << right << "SparseExtra" << setw(Stats::width()) << stats.extra << endl;
             return os;
         }
 
         SuffixArrayStats& operator += (const SuffixArrayStats &stats) {
-            if (arrays == 0U) {
+            if (arrays == 0U && skipped == 0U) {
                 *this = stats;
             }
             else {
                 arrays += stats.arrays;
                 suffixes.push_back(stats.suffixes);
                 pairs.push_back(stats.pairs);
+                unique.push_back(stats.unique);
                 time_build.push_back(stats.time_build);
                 time_process.push_back(stats.time_process);
+                time_overlap.push_back(stats.time_overlap);
+                time_wait.push_back(stats.time_wait);
+                skipped += stats.skipped;
+                time_skipped.push_back(stats.time_skipped);
+                faults.push_back(stats.faults);
+                workspace = workspace > stats.workspace ? workspace : stats.workspace;
+                wide += stats.wide;
+                bytes.push_back(stats.bytes);
+                queue.push_back(stats.queue);
+                time_stall.push_back(stats.time_stall);
+                full += stats.full;
+                masked.push_back(stats.masked);
+                heavy.push_back(stats.heavy);
+                sparse += stats.sparse;
+                missing += stats.missing;
+                extra += stats.extra;
                 time_first = time_first < stats.time_first ? time_first : stats.time_first;
                 time_last = time_last > stats.time_last ? time_last : stats.time_last;
             }
@@ -0,0 +1,115 @@
+/**
+ * @file TileWorkspace.cpp
+ *
+ * @author agent@local
+ *
+ * Copyright 2026 agent. All rights reserved.
+ */
+#include "config.h"
+
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/time.h>
+
+#include <cstdlib>
+#include <new>
+
+#include "TileWorkspace.hpp"
+
+/* size of a transparent huge page on x86-64 */
+#define HUGE_PAGE_SIZE (2UL<<20)
+
+namespace pgraph {
+
+TileWorkspace::TileWorkspace(bool huge_pages)
+    : _slots()
+    , _huge_pages(huge_pages)
+    , _footprint(0)
+    , _peak(0)
+    , _grows(0)
+{
+}
+
+
+TileWorkspace::~TileWorkspace()
+{
+    clear();
+}
+
+
+void TileWorkspace::clear()
+{
+    for (size_t i=0; i<_slots.size(); ++i) {
+        free(_slots[i].ptr);
+        _slots[i] = Slot();
+    }
+    _footprint = 0;
+}
+
+
+void* TileWorkspace::reserve(size_t slot, size_t bytes)
+{
+    if (slot >= _slots.size()) {
+        _slots.resize(slot+1);
+    }
+
+    Slot &s = _slots[slot];
+    if (bytes <= s.bytes) {
+        return s.ptr;
+    }
+
+    /* growing copies nothing, so free first to let the space be reused */
+    free(s.ptr);
+    _footprint -= s.bytes;
+    s = Slot();
+
+    void *ptr = NULL;
+    bytes = rounded(bytes);
+    if (bytes >= HUGE_PAGE_SIZE) {
+        if (0 != posix_memalign(&ptr, HUGE_PAGE_SIZE, bytes)) {
+            throw std::bad_alloc();
+        }
+#ifdef MADV_HUGEPAGE
+        if (_huge_pages) {
+            (void)madvise(ptr, bytes, MADV_HUGEPAGE);
+        }
+#endif
+    }
+    else {
+        ptr = malloc(bytes);
+        if (NULL == ptr) {
+            throw std::bad_alloc();
+        }
+    }
+
+    s.ptr = ptr;
+    s.bytes = bytes;
+    _footprint += bytes;
+    if (_footprint > _peak) {
+        _peak = _footprint;
+    }
+    ++_grows;
+
+    return ptr;
+}
+
+
+unsigned long TileWorkspace::page_faults()
+{
+    struct rusage usage;
+    if (0 != getrusage(RUSAGE_SELF, &usage)) {
+        return 0;
+    }
+    return usage.ru_minflt + usage.ru_majflt;
+}
+
+
+size_t TileWorkspace::rounded(size_t bytes)
+{
+    if (bytes >= HUGE_PAGE_SIZE) {
+        bytes = (bytes + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1);
+    }
+    return bytes;
+}
+
+}; /* namespace pgraph */
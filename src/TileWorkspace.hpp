@@ -0,0 +1,76 @@
+/**
+ * @file TileWorkspace.hpp
+ *
+ * @author agent@local
+ *
+ * Copyright 2026 agent. All rights reserved.
+ *
+ * Scratch buffers reused from one tile to the next. Each slot grows to the
+ * largest request it has seen and is never shrunk, so after the first few
+ * tiles the allocator is not touched and the pages stay mapped. Slots of at
+ * least a huge page are aligned to one and, when enabled, advised to use
+ * transparent huge pages.
+ */
+#ifndef _PGRAPH_TILE_WORKSPACE_H_
+#define _PGRAPH_TILE_WORKSPACE_H_
+
+#include <cstddef>
+#include <vector>
+
+namespace pgraph {
+
+class TileWorkspace
+{
+    public:
+        TileWorkspace(bool huge_pages=true);
+        ~TileWorkspace();
+
+        /** Returns the buffer of the given slot holding at least count
+         * objects of type T; its previous contents are not preserved. */
+        template <class T>
+        T* get(size_t slot, size_t count) {
+            return static_cast<T*>(reserve(slot, count * sizeof(T)));
+        }
+
+        /** Frees every slot. */
+        void clear();
+
+        /** Bytes currently held by all slots. */
+        size_t footprint() const { return _footprint; }
+
+        /** Largest footprint reached. */
+        size_t peak() const { return _peak; }
+
+        /** Number of times a slot had to be reallocated. */
+        unsigned long grows() const { return _grows; }
+
+        /** Minor plus major page faults of this process so far. */
+        static unsigned long page_faults();
+
+        /** Bytes a slot holds for a request of the given size: a whole
+         * number of huge pages once it reaches one. */
+        static size_t rounded(size_t bytes);
+
+    private:
+        struct Slot {
+            void *ptr;
+            size_t bytes;
+            Slot() : ptr(NULL), bytes(0) {}
+        };
+
+        void* reserve(size_t slot, size_t bytes);
+
+        /* not copyable */
+        TileWorkspace(const TileWorkspace &);
+        TileWorkspace& operator=(const TileWorkspace &);
+
+        std::vector<Slot> _slots;
+        bool _huge_pages;
+        size_t _footprint;
+        size_t _peak;
+        unsigned long _grows;
+};
+
+}; /* namespace pgraph */
+
+#endif /* _PGRAPH_TILE_WORKSPACE_H_ */
@@ -9,11 +9,17 @@
  */
 #include "config.h"
 
+#include <stdint.h>
+
+#include <algorithm>
 #include <cassert>
 #include <climits>
 #include <cstdio>
 #include <cstdlib>
 #include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include "parasail.h"
 
@@ -21,6 +27,25 @@
 
 using std::cerr;
 using std::endl;
+using std::lower_bound;
+using std::make_pair;
+using std::max;
+using std::min;
+using std::pair;
+using std::sort;
+using std::string;
+using std::upper_bound;
+using std::vector;
+
+/* base of the rolling hash of seed k-mers */
+#define SEED_HASH_BASE 1000003ULL
+
+/* a k-mer found more often than this in sequence one casts no votes,
+ * which keeps low-complexity runs from costing len1*len2 */
+#define SEED_MAX_OCCURRENCES 8
+
+/* below any score an alignment can reach */
+#define BAND_NEG_INF (INT_MIN/2)
 
 namespace pgraph {
 
@@ -41,6 +66,215 @@ int self_score(
 }
 
 
+string profile_function(const string &function)
+{
+    size_t last = function.rfind('_');
+
+    if (string::npos == last) {
+        return function;
+    }
+
+    return function.substr(0, last) + "_profile" + function.substr(last);
+}
+
+
+/* SEED_HASH_BASE to the power k-1, which rolls a residue out of a seed */
+static inline uint64_t seed_power(int k)
+{
+    uint64_t power = 1;
+
+    for (int i = 1; i < k; i++) {
+        power *= SEED_HASH_BASE;
+    }
+
+    return power;
+}
+
+
+void seed_kmers(
+        const char * const restrict s1, size_t s1_len,
+        int k,
+        BandWorkspace &workspace)
+{
+    vector<pair<uint64_t,int> > &kmers = workspace.kmers;
+    uint64_t power = seed_power(k);
+    uint64_t hash = 0;
+
+    kmers.clear();
+    if (k <= 0 || s1_len < size_t(k)) {
+        return;
+    }
+
+    for (size_t p = 0; p < s1_len; p++) {
+        if (p >= size_t(k)) {
+            hash -= power * (unsigned char)s1[p-k];
+        }
+        hash = hash * SEED_HASH_BASE + (unsigned char)s1[p];
+        if (p + 1 >= size_t(k)) {
+            kmers.push_back(make_pair(hash, int(p + 1 - k)));
+        }
+    }
+    sort(kmers.begin(), kmers.end());
+}
+
+
+bool seed_diagonal(
+        size_t s1_len,
+        const char * const restrict s2, size_t s2_len,
+        int k,
+        BandWorkspace &workspace,
+        int &diagonal)
+{
+    const vector<pair<uint64_t,int> > &kmers = workspace.kmers;
+    vector<int> &votes = workspace.votes;
+    uint64_t power = seed_power(k);
+    uint64_t hash = 0;
+    int best = 0;
+
+    if (kmers.empty() || s2_len < size_t(k)) {
+        return false;
+    }
+
+    /* votes[d + s1_len] counts the matches on diagonal d */
+    votes.assign(s1_len + s2_len, 0);
+    for (size_t p = 0; p < s2_len; p++) {
+        if (p >= size_t(k)) {
+            hash -= power * (unsigned char)s2[p-k];
+        }
+        hash = hash * SEED_HASH_BASE + (unsigned char)s2[p];
+        if (p + 1 >= size_t(k)) {
+            vector<pair<uint64_t,int> >::const_iterator first;
+            vector<pair<uint64_t,int> >::const_iterator last;
+            first = lower_bound(kmers.begin(), kmers.end(),
+                    make_pair(hash, INT_MIN));
+            last = upper_bound(first, kmers.end(),
+                    make_pair(hash, INT_MAX));
+            if (last - first > SEED_MAX_OCCURRENCES) {
+                continue;
+            }
+            for (; first != last; ++first) {
+                int d = int(p + 1 - k) - first->second;
+                int v = ++votes[d + s1_len];
+                if (v > best) {
+                    best = v;
+                    diagonal = d;
+                }
+            }
+        }
+    }
+
+    return best > 0;
+}
+
+
+static inline void band_extend(BandCell &cell, const BandCell &from,
+        int score, int matches, int similar, bool clipped)
+{
+    cell.score = score;
+    cell.matches = from.matches + matches;
+    cell.similar = from.similar + similar;
+    cell.length = from.length + 1;
+    cell.clipped = from.clipped || clipped;
+}
+
+
+bool sw_banded_stats(
+        const char * const restrict s1, int s1_len,
+        const char * const restrict s2, int s2_len,
+        int open, int gap,
+        const parasail_matrix_t *matrix,
+        int diagonal, int band,
+        BandWorkspace &workspace,
+        parasail_result_t &result)
+{
+    const BandCell empty = {0, 0, 0, 0, false};
+    const BandCell none = {BAND_NEG_INF, 0, 0, 0, false};
+    /* row i-1 until overwritten by row i; the band only moves right, so
+     * a column entering it holds the initial values */
+    vector<BandCell> &H = workspace.H;
+    vector<BandCell> &E = workspace.E;
+    BandCell best = empty;
+    int best_i = 0;
+    int best_j = 0;
+
+    assert(s1);
+    assert(s2);
+    assert(matrix);
+
+    H.assign(s2_len + 1, empty);
+    E.assign(s2_len + 1, none);
+    for (int i = 1; i <= s1_len; i++) {
+        int j_lo = max(1, i + diagonal - band);
+        int j_hi = min(s2_len, i + diagonal + band);
+        const int *row = &matrix->matrix[
+            matrix->mapper[(unsigned char)s1[i-1]] * matrix->size];
+        BandCell diag;
+        BandCell left = empty; /* H[i][j_lo-1] lies outside the band */
+        BandCell F = none;
+
+        if (j_lo > j_hi) {
+            continue;
+        }
+        diag = H[j_lo-1];
+
+        for (int j = j_lo; j <= j_hi; j++) {
+            /* a neighbor outside the band could have led here */
+            bool edge = (j - i == diagonal - band && j > 1)
+                || (j - i == diagonal + band && i > 1);
+            int sub = row[matrix->mapper[(unsigned char)s2[j-1]]];
+            int d = diag.score + sub;
+            BandCell up = H[j];
+            BandCell cell;
+
+            if (up.score - open >= E[j].score - gap) {
+                band_extend(E[j], up, up.score - open, 0, 0, edge);
+            }
+            else {
+                band_extend(E[j], E[j], E[j].score - gap, 0, 0, edge);
+            }
+            if (left.score - open >= F.score - gap) {
+                band_extend(F, left, left.score - open, 0, 0, edge);
+            }
+            else {
+                band_extend(F, F, F.score - gap, 0, 0, edge);
+            }
+
+            if (d >= E[j].score && d >= F.score && d > 0) {
+                band_extend(cell, diag, d,
+                        s1[i-1] == s2[j-1], sub > 0, edge);
+            }
+            else if (E[j].score >= F.score && E[j].score > 0) {
+                cell = E[j];
+            }
+            else if (F.score > 0) {
+                cell = F;
+            }
+            else {
+                cell = empty;
+            }
+
+            diag = up;
+            H[j] = cell;
+            left = cell;
+            if (cell.score > best.score) {
+                best = cell;
+                best_i = i - 1;
+                best_j = j - 1;
+            }
+        }
+    }
+
+    result.score = best.score;
+    result.matches = best.matches;
+    result.similar = best.similar;
+    result.length = best.length;
+    result.end_query = best_i;
+    result.end_ref = best_j;
+
+    return !best.clipped;
+}
+
+
 #define IS_EDGE_ASSERT  \
     assert(s1);         \
     assert(s2);         \
@@ -89,5 +323,23 @@ bool is_edge(
                  self_score(s2, s2_len, matrix))
 }
 
+
+bool is_edge(
+        const parasail_result_t *result,
+        size_t s1_len, int s1_self_score,
+        size_t s2_len, int s2_self_score,
+        int AOL,
+        int SIM,
+        int OS,
+        int &self_score_,
+        size_t &max_len)
+{
+    assert(result);
+    assert(s1_len);
+    assert(s2_len);
+
+    IS_EDGE_BODY(s1_self_score, s2_self_score)
+}
+
 }; /* namespace pgraph */
 
@@ -16,7 +16,12 @@
 #ifndef _PGRAPH_ALIGNMENT_H_
 #define _PGRAPH_ALIGNMENT_H_
 
+#include <stdint.h>
+
 #include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include "parasail.h"
 
@@ -35,6 +40,101 @@ namespace pgraph {
 int self_score(const char * const restrict seq, size_t len,
                const parasail_matrix_t *matrix);
 
+/**
+ * Name under which parasail registers the profile variant of a function,
+ * "_profile" inserted before the width, e.g. sw_stats_striped_profile_16
+ * for sw_stats_striped_16.
+ *
+ * @param[in] function name of the parasail function
+ * @return name of its profile variant
+ */
+std::string profile_function(const std::string &function);
+
+/** A cell of the banded DP: its score and the path ending there. */
+struct BandCell {
+    int score;
+    int matches;
+    int similar;
+    int length;
+    bool clipped; /**< the path touches an edge of the band */
+};
+
+/**
+ * Buffers of seed_kmers, seed_diagonal and sw_banded_stats. Keeping one
+ * per thread spares aligning a pair any allocation, and the seeds of
+ * sequence one stay valid for each of its partners.
+ */
+struct BandWorkspace {
+    std::vector<std::pair<uint64_t,int> > kmers; /**< seeds of sequence one */
+    std::vector<int> votes;
+    std::vector<BandCell> H;
+    std::vector<BandCell> E;
+};
+
+/**
+ * Hashes the k residue seeds of s1 into workspace.kmers, sorted.
+ *
+ * @param[in] s1 character sequence one
+ * @param[in] s1_len length of character sequence one
+ * @param[in] k length of the seeds
+ * @param[in,out] workspace holds the seeds
+ */
+void seed_kmers(
+        const char * const restrict s1, size_t s1_len,
+        int k,
+        BandWorkspace &workspace);
+
+/**
+ * Finds the diagonal, the offset in s2 minus the offset in s1, holding the
+ * most exact matches of k residues between the two sequences.
+ *
+ * @param[in] s1_len length of character sequence one
+ * @param[in] s2 character sequence two
+ * @param[in] s2_len length of character sequence two
+ * @param[in] k length of the exact matches
+ * @param[in,out] workspace seeds of s1 from seed_kmers with the same k
+ * @param[out] diagonal the diagonal found
+ * @return false if the sequences share no k residues
+ */
+bool seed_diagonal(
+        size_t s1_len,
+        const char * const restrict s2, size_t s2_len,
+        int k,
+        BandWorkspace &workspace,
+        int &diagonal);
+
+/**
+ * Smith-Waterman with affine gaps and alignment statistics, restricted to
+ * the cells within band of the given diagonal. Gaps are charged as by
+ * parasail: open for the first residue, gap for each further one.
+ *
+ * Only score, matches, similar, length, end_query and end_ref of result
+ * are set. The band clips the alignment if the best path reaches one of
+ * its edges. A path elsewhere may score higher either way, so the caller
+ * should compare the score with that of the full alignment.
+ *
+ * @param[in] s1 character sequence one
+ * @param[in] s1_len length of character sequence one
+ * @param[in] s2 character sequence two
+ * @param[in] s2_len length of character sequence two
+ * @param[in] open gap open penalty, positive
+ * @param[in] gap gap extension penalty, positive
+ * @param[in] matrix substitution matrix
+ * @param[in] diagonal offset in s2 minus offset in s1 of the band center
+ * @param[in] band cells this far off the diagonal are computed
+ * @param[in,out] workspace holds the DP rows
+ * @param[out] result the alignment statistics
+ * @return false if the band clipped the alignment
+ */
+bool sw_banded_stats(
+        const char * const restrict s1, int s1_len,
+        const char * const restrict s2, int s2_len,
+        int open, int gap,
+        const parasail_matrix_t *matrix,
+        int diagonal, int band,
+        BandWorkspace &workspace,
+        parasail_result_t &result);
+
 /** @name Edge Functions
  *
  * Asks whether the given parasail alignment result is an edge, based on
@@ -94,6 +194,23 @@ bool is_edge(
         size_t &max_len,
         const parasail_matrix_t *matrix);
 
+/**
+ * As above, with the self scores of both sequences computed beforehand,
+ * e.g. once per sequence of a database rather than once per alignment.
+ *
+ * @param[in] s1_self_score self score of character sequence one
+ * @param[in] s2_self_score self score of character sequence two
+ */
+bool is_edge(
+        const parasail_result_t *result,
+        size_t s1_len, int s1_self_score,
+        size_t s2_len, int s2_self_score,
+        int AOL,
+        int SIM,
+        int OS,
+        int &self_score,
+        size_t &max_len);
+
 /** @} */
 
 }; /* namespace pgraph */
@@ -0,0 +1,335 @@
+/**
+ * @file esa_traversal.hpp
+ *
+ * @author agent@local
+ *
+ * Copyright 2026 agent. All rights reserved.
+ *
+ * Bottom-up traversal of the l-intervals of an enhanced suffix array,
+ * generating the pairs of sequences sharing a maximal exact match of at
+ * least cutoff residues. SA_filter of align_parted_nxtval traverses each
+ * chunk of a tile with it, as does tests/test_esa_traversal.
+ *
+ * Header-only so the pair sink, which streams pairs to alignment or keeps
+ * them in memory, is resolved at compile time.
+ */
+#ifndef _PGRAPH_ESA_TRAVERSAL_H_
+#define _PGRAPH_ESA_TRAVERSAL_H_
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <climits>
+#include <cstddef>
+#include <stack>
+#include <vector>
+
+#include "radix_sort.hpp"
+
+namespace pgraph {
+
+/* candidate pairs are packed as (first << 32) | second; sorting the keys
+ * orders the pairs as a set<pair<int,int> > would */
+typedef std::vector<uint64_t> PairVec;
+
+static inline uint64_t pair_key(int first, int second)
+{
+    return (uint64_t(first) << 32) | uint32_t(second);
+}
+
+static inline int pair_first(uint64_t key) { return int(key >> 32); }
+static inline int pair_second(uint64_t key) { return int(key & 0xFFFFFFFF); }
+
+/* per-chunk pair buffers are sorted and deduplicated whenever they grow
+ * past this many keys, which bounds memory on highly repetitive tiles */
+#define PAIR_COMPACT_SIZE (1UL<<22)
+
+/* Keeps a traversal's pairs in memory, sorting and deduplicating them
+ * whenever they double past the given size, PAIR_COMPACT_SIZE unless a
+ * memory budget asks for less. */
+struct PairCompactor {
+    size_t size;
+
+    explicit PairCompactor(size_t size=PAIR_COMPACT_SIZE)
+        : size(size) {}
+
+    void added(PairVec &pairs) {
+        if (pairs.size() > size) {
+            radix_sort_unique(pairs);
+            size = std::max(size, 2*pairs.size());
+        }
+    }
+
+    void finished(PairVec &) {}
+};
+
+/* boundaries of a child l-interval */
+struct interval {
+    long lb;
+    long rb;
+
+    interval(long lb, long rb)
+        : lb(lb), rb(rb) {}
+};
+
+/* The children of an l-interval are not stored in the quad. While an
+ * interval is on the traversal stack its children are the entries of a
+ * shared child stack from index 'children' to the top, since any interval
+ * pushed later is popped, and its own children discarded, first. */
+struct quad {
+    int lcp;
+    long lb;
+    long rb;
+    int children;
+
+    quad()
+        : lcp(0), lb(0), rb(LONG_MAX), children(0) {}
+    quad(int lcp, long lb, long rb, int children)
+        : lcp(lcp), lb(lb), rb(rb), children(children) {}
+
+    bool empty() { return rb == LONG_MAX; }
+};
+
+typedef std::vector<interval> ChildStack;
+
+/* an l-interval wider than HeavyIntervalWidth */
+struct heavy_interval {
+    int lcp;
+    long lb;
+    long width;
+    long sids; /* distinct unmasked sequences among its suffixes */
+
+    heavy_interval(int lcp, long lb, long width, long sids)
+        : lcp(lcp), lb(lb), width(width), sids(sids) {}
+
+    bool operator < (const heavy_interval &other) const {
+        return width > other.width;
+    }
+};
+
+/* what the traversal of one chunk of a tile's suffix array found */
+struct PairCounts {
+    unsigned long generated;
+    unsigned long masked; /* left out since a suffix starts in a masked region */
+    std::vector<heavy_interval> heavy;
+
+    PairCounts()
+        : generated(0), masked(0), heavy() {}
+
+    PairCounts& operator += (const PairCounts &other) {
+        generated += other.generated;
+        masked += other.masked;
+        heavy.insert(heavy.end(), other.heavy.begin(), other.heavy.end());
+        return *this;
+    }
+};
+
+/* consecutive checks often yield the same pair, skip those here */
+static inline void add_pair(PairVec &pairs, int sidi, int sidj)
+{
+    uint64_t key = (sidi < sidj) ? pair_key(sidi,sidj) : pair_key(sidj,sidi);
+    if (pairs.empty() || pairs.back() != key) {
+        pairs.push_back(key);
+    }
+}
+
+/* SID holds the sequence id of each suffix in SA order, so the pairs
+ * are read without touching the text; a suffix starting in a masked
+ * region has its id complemented and seeds no pair */
+static void pair_check(
+        PairCounts &counts,
+        PairVec &pairs,
+        const long &i,
+        const long &j,
+        const unsigned char * const restrict BWT,
+        const int * const restrict SID,
+        int sid_crossover,
+        const char &sentinal)
+{
+    int sidi = SID[i];
+    int sidj = SID[j];
+    if (BWT[i] != BWT[j] || BWT[i] == sentinal) {
+        bool masked = sidi < 0 || sidj < 0;
+        bool found = false;
+        if (masked) {
+            sidi = sidi < 0 ? ~sidi : sidi;
+            sidj = sidj < 0 ? ~sidj : sidj;
+        }
+        if (0 == sid_crossover) {
+            found = sidi != sidj;
+        }
+        else {
+            found = (sidi < sid_crossover && sidj >= sid_crossover)
+                || (sidj < sid_crossover && sidi >= sid_crossover);
+        }
+        if (found) {
+            if (masked) {
+                ++counts.masked;
+            }
+            else {
+                ++counts.generated;
+                add_pair(pairs, sidi, sidj);
+            }
+        }
+    }
+}
+
+/* Guard against l-intervals of many suffixes, which come from k-mers
+ * repeated within and across a few sequences. Every pair of distinct
+ * sequences in the interval shares its prefix, so the pairs are emitted
+ * once per pair of sequences instead of once per pair of suffixes. Left
+ * maximality is not checked; that can only repeat pairs the traversal
+ * finds elsewhere anyway, never add new ones. */
+static void process_heavy(
+        PairCounts &counts,
+        PairVec &pairs,
+        const quad &q,
+        const int * const restrict SID,
+        int sid_crossover)
+{
+    std::vector<int> sids;
+    size_t split = 0;
+
+    sids.reserve(q.rb - q.lb + 1);
+    for (long i=q.lb; i<=q.rb; ++i) {
+        if (SID[i] >= 0) {
+            sids.push_back(SID[i]);
+        }
+    }
+    std::sort(sids.begin(), sids.end());
+    sids.erase(std::unique(sids.begin(), sids.end()), sids.end());
+
+    if (0 == sid_crossover) {
+        for (size_t a=0; a<sids.size(); ++a) {
+            for (size_t b=a+1; b<sids.size(); ++b) {
+                ++counts.generated;
+                add_pair(pairs, sids[a], sids[b]);
+            }
+        }
+    }
+    else {
+        split = std::lower_bound(sids.begin(), sids.end(), sid_crossover)
+            - sids.begin();
+        for (size_t a=0; a<split; ++a) {
+            for (size_t b=split; b<sids.size(); ++b) {
+                ++counts.generated;
+                add_pair(pairs, sids[a], sids[b]);
+            }
+        }
+    }
+
+    counts.heavy.push_back(heavy_interval(
+                q.lcp, q.lb, q.rb - q.lb + 1, sids.size()));
+}
+
+/* try to reduce number of duplicate pairs generated */
+/* we observe that l-intervals (i.e. internal nodes) always have at
+ * least two children, but these children could be singleton
+ * l-intervals, e.g., [i..j]=[1..1], in addition to l-intervals with
+ * non-singleton ranges/quads. For each l-interval, we take the cross
+ * product of its child l-intervals. Naively, we could take the cross
+ * product of the entire lb/rb range of the l-interval, but this
+ * generates too many duplicate pairs. Instead, the complexity should be
+ * bounded by the number of exact matches...
+ */
+static void process(
+        PairCounts &counts,
+        PairVec &pairs,
+        const quad &q,
+        const ChildStack &children,
+        const unsigned char * const restrict BWT,
+        const int * const restrict SID,
+        int sid_crossover,
+        const char &sentinal,
+        const int &cutoff,
+        long heavy)
+{
+    const int n_children = children.size();
+    int child_index = q.children;
+
+    if (q.lcp < cutoff) return;
+
+    if (heavy > 0 && q.rb - q.lb + 1 > heavy) {
+        process_heavy(counts, pairs, q, SID, sid_crossover);
+        return;
+    }
+
+    if (n_children > child_index) {
+        for (long i=q.lb; i<=q.rb; ++i) {
+            long j = i+1;
+            if (child_index < n_children) {
+                if (i >= children[child_index].lb) {
+                    j = children[child_index].rb+1;
+                    if (i >= children[child_index].rb) {
+                        ++child_index;
+                    }
+                }
+            }
+            for (/*nope*/; j<=q.rb; ++j) {
+                pair_check(counts, pairs, i, j, BWT, SID, sid_crossover, sentinal);
+            }
+        }
+    }
+    else {
+        for (long i=q.lb; i<=q.rb; ++i) {
+            for (long j=i+1; j<=q.rb; ++j) {
+                pair_check(counts, pairs, i, j, BWT, SID, sid_crossover, sentinal);
+            }
+        }
+    }
+}
+
+/* bottom-up traversal of SA[start..stop]; start must be the first suffix
+ * or have LCP below the cutoff, and only l-intervals closed by stop are
+ * reported unless stop is the end of the SA. sink.added(pairs) is called
+ * after each l-interval and sink.finished(pairs) at the end. */
+template <class Sink>
+static void lcp_intervals(
+        PairCounts &counts,
+        PairVec &pairs,
+        long start,
+        long stop,
+        const int * const restrict LCP,
+        const unsigned char * const restrict BWT,
+        const int * const restrict SID,
+        int sid_crossover,
+        const char &sentinal,
+        const int &cutoff,
+        long heavy,
+        Sink &sink)
+{
+    std::stack<quad, std::vector<quad> > the_stack;
+    ChildStack children;
+    quad last_interval;
+    the_stack.push(quad());
+    for (long i = start; i <= stop; ++i) {
+        long lb = i - 1;
+        while (LCP[i] < the_stack.top().lcp) {
+            the_stack.top().rb = i - 1;
+            last_interval = the_stack.top();
+            the_stack.pop();
+            process(counts, pairs, last_interval, children, BWT, SID, sid_crossover, sentinal, cutoff, heavy);
+            sink.added(pairs);
+            children.resize(last_interval.children, interval(0,0));
+            lb = last_interval.lb;
+            if (LCP[i] <= the_stack.top().lcp) {
+                children.push_back(interval(last_interval.lb, last_interval.rb));
+                last_interval = quad();
+            }
+        }
+        if (LCP[i] > the_stack.top().lcp) {
+            the_stack.push(quad(LCP[i],lb,LONG_MAX,children.size()));
+            if (!last_interval.empty()) {
+                children.push_back(interval(last_interval.lb, last_interval.rb));
+                last_interval = quad();
+            }
+        }
+    }
+    the_stack.top().rb = stop - 1;
+    process(counts, pairs, the_stack.top(), children, BWT, SID, sid_crossover, sentinal, cutoff, heavy);
+    sink.finished(pairs);
+}
+
+}; /* namespace pgraph */
+
+#endif /* _PGRAPH_ESA_TRAVERSAL_H_ */
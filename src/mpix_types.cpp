@@ -160,26 +160,60 @@ static void build_mpi_datatype_Stats()
 static void build_mpi_datatype_SuffixArrayStats()
 {
     SuffixArrayStats object;
-    MPI_Datatype type[7] = {
+    MPI_Datatype type[24] = {
         get_mpi_datatype(object.arrays),
         get_mpi_datatype(object.suffixes),
         get_mpi_datatype(object.pairs),
+        get_mpi_datatype(object.unique),
         get_mpi_datatype(object.time_build),
         get_mpi_datatype(object.time_process),
+        get_mpi_datatype(object.time_overlap),
+        get_mpi_datatype(object.time_wait),
+        get_mpi_datatype(object.skipped),
+        get_mpi_datatype(object.time_skipped),
+        get_mpi_datatype(object.faults),
+        get_mpi_datatype(object.workspace),
+        get_mpi_datatype(object.wide),
+        get_mpi_datatype(object.bytes),
+        get_mpi_datatype(object.queue),
+        get_mpi_datatype(object.time_stall),
+        get_mpi_datatype(object.full),
+        get_mpi_datatype(object.masked),
+        get_mpi_datatype(object.heavy),
+        get_mpi_datatype(object.sparse),
+        get_mpi_datatype(object.missing),
+        get_mpi_datatype(object.extra),
         get_mpi_datatype(object.time_first),
         get_mpi_datatype(object.time_last)
     };
-    int blocklen[7] = {1,1,1,1,1,1,1};
-    MPI_Aint disp[7] = {
+    int blocklen[24] = {1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1};
+    MPI_Aint disp[24] = {
         MPI_Aint(&object.arrays)        - MPI_Aint(&object),
         MPI_Aint(&object.suffixes)      - MPI_Aint(&object),
         MPI_Aint(&object.pairs)         - MPI_Aint(&object),
+        MPI_Aint(&object.unique)        - MPI_Aint(&object),
         MPI_Aint(&object.time_build)    - MPI_Aint(&object),
         MPI_Aint(&object.time_process)  - MPI_Aint(&object),
+        MPI_Aint(&object.time_overlap)  - MPI_Aint(&object),
+        MPI_Aint(&object.time_wait)     - MPI_Aint(&object),
+        MPI_Aint(&object.skipped)       - MPI_Aint(&object),
+        MPI_Aint(&object.time_skipped)  - MPI_Aint(&object),
+        MPI_Aint(&object.faults)        - MPI_Aint(&object),
+        MPI_Aint(&object.workspace)     - MPI_Aint(&object),
+        MPI_Aint(&object.wide)          - MPI_Aint(&object),
+        MPI_Aint(&object.bytes)         - MPI_Aint(&object),
+        MPI_Aint(&object.queue)         - MPI_Aint(&object),
+        MPI_Aint(&object.time_stall)    - MPI_Aint(&object),
+        MPI_Aint(&object.full)          - MPI_Aint(&object),
+        MPI_Aint(&object.masked)        - MPI_Aint(&object),
+        MPI_Aint(&object.heavy)         - MPI_Aint(&object),
+        MPI_Aint(&object.sparse)        - MPI_Aint(&object),
+        MPI_Aint(&object.missing)       - MPI_Aint(&object),
+        MPI_Aint(&object.extra)         - MPI_Aint(&object),
         MPI_Aint(&object.time_first)    - MPI_Aint(&object),
         MPI_Aint(&object.time_last)     - MPI_Aint(&object)
     };
-    type_create_struct(7, blocklen, disp, type, mpi_datatype_SuffixArrayStats);
+    type_create_struct(24, blocklen, disp, type, mpi_datatype_SuffixArrayStats);
     type_commit(mpi_datatype_SuffixArrayStats);
 }
 
@@ -270,7 +304,7 @@ static void build_mpi_datatype_DupStats()
 static void build_mpi_datatype_AlignStats()
 {
     AlignStats object;
-    MPI_Datatype type[8] = {
+    MPI_Datatype type[15] = {
         get_mpi_datatype(object.edge_counts),
         get_mpi_datatype(object.align_counts),
         get_mpi_datatype(object.align_skipped),
@@ -278,10 +312,17 @@ static void build_mpi_datatype_AlignStats()
         get_mpi_datatype(object.time_kcomb),
         get_mpi_datatype(object.time_total),
         get_mpi_datatype(object.work),
-        get_mpi_datatype(object.work_skipped)
+        get_mpi_datatype(object.work_skipped),
+        get_mpi_datatype(object.profiles),
+        get_mpi_datatype(object.time_profile),
+        get_mpi_datatype(object.screened),
+        get_mpi_datatype(object.rejected),
+        get_mpi_datatype(object.time_screen),
+        get_mpi_datatype(object.banded),
+        get_mpi_datatype(object.unbanded)
     };
-    int blocklen[8] = {1,1,1,1,1,1,1,1};
-    MPI_Aint disp[8] = {
+    int blocklen[15] = {1,1,1,1,1,1,1,1,1,1,1,1,1,1,1};
+    MPI_Aint disp[15] = {
         MPI_Aint(&object.edge_counts)   - MPI_Aint(&object),
         MPI_Aint(&object.align_counts)  - MPI_Aint(&object),
         MPI_Aint(&object.align_skipped) - MPI_Aint(&object),
@@ -289,9 +330,16 @@ static void build_mpi_datatype_AlignStats()
         MPI_Aint(&object.time_kcomb)    - MPI_Aint(&object),
         MPI_Aint(&object.time_total)    - MPI_Aint(&object),
         MPI_Aint(&object.work)          - MPI_Aint(&object),
-        MPI_Aint(&object.work_skipped)  - MPI_Aint(&object)
+        MPI_Aint(&object.work_skipped)  - MPI_Aint(&object),
+        MPI_Aint(&object.profiles)      - MPI_Aint(&object),
+        MPI_Aint(&object.time_profile)  - MPI_Aint(&object),
+        MPI_Aint(&object.screened)      - MPI_Aint(&object),
+        MPI_Aint(&object.rejected)      - MPI_Aint(&object),
+        MPI_Aint(&object.time_screen)   - MPI_Aint(&object),
+        MPI_Aint(&object.banded)        - MPI_Aint(&object),
+        MPI_Aint(&object.unbanded)      - MPI_Aint(&object)
     };
-    type_create_struct(8, blocklen, disp, type, mpi_datatype_AlignStats);
+    type_create_struct(15, blocklen, disp, type, mpi_datatype_AlignStats);
     type_commit(mpi_datatype_AlignStats);
 }
 
@@ -0,0 +1,118 @@
+/**
+ * @file radix_sort.hpp
+ *
+ * @author agent@local
+ *
+ * Copyright 2026 agent. All rights reserved.
+ *
+ * LSD radix sort of 64-bit keys, one byte per pass, used to deduplicate
+ * candidate pairs packed as (first << 32) | second. Passes whose byte is
+ * the same for every key are skipped, so keys built from small sequence
+ * ids only pay for the bytes that actually vary.
+ *
+ * Header-only so the OpenMP directives follow the flags of the including
+ * program. Inside an existing parallel region it runs on one thread.
+ */
+#ifndef _PGRAPH_RADIX_SORT_H_
+#define _PGRAPH_RADIX_SORT_H_
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include <stdint.h>
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+namespace pgraph {
+
+/**
+ * Sorts keys[0..n-1] in place; tmp must hold n keys.
+ */
+static void radix_sort(uint64_t *keys, uint64_t *tmp, size_t n)
+{
+    const int RADIX = 256;
+    int nthreads = 1;
+
+    if (n < 2) {
+        return;
+    }
+
+#ifdef _OPENMP
+    if (!omp_in_parallel() && n > 65536) {
+        nthreads = omp_get_max_threads();
+    }
+#endif
+
+    std::vector<size_t> counts((size_t)nthreads * RADIX);
+    uint64_t *src = keys;
+    uint64_t *dst = tmp;
+
+    for (int shift = 0; shift < 64; shift += 8) {
+        bool skip = false;
+
+        std::fill(counts.begin(), counts.end(), 0);
+#pragma omp parallel num_threads(nthreads)
+        {
+            int tid = 0;
+#ifdef _OPENMP
+            tid = omp_get_thread_num();
+#endif
+            size_t *count = &counts[(size_t)tid * RADIX];
+#pragma omp for schedule(static)
+            for (long i = 0; i < (long)n; ++i) {
+                ++count[(src[i] >> shift) & 0xFF];
+            }
+#pragma omp single
+            {
+                size_t sum = 0;
+                for (int b = 0; b < RADIX; ++b) {
+                    size_t bucket = 0;
+                    for (int t = 0; t < nthreads; ++t) {
+                        size_t c = counts[(size_t)t * RADIX + b];
+                        counts[(size_t)t * RADIX + b] = sum;
+                        sum += c;
+                        bucket += c;
+                    }
+                    if (bucket == n) {
+                        skip = true;
+                    }
+                }
+            }
+            if (!skip) {
+                /* same static schedule as the counting loop keeps the
+                 * scatter stable */
+#pragma omp for schedule(static)
+                for (long i = 0; i < (long)n; ++i) {
+                    dst[count[(src[i] >> shift) & 0xFF]++] = src[i];
+                }
+            }
+        }
+        if (!skip) {
+            std::swap(src, dst);
+        }
+    }
+
+    if (src != keys) {
+        std::copy(src, src + n, keys);
+    }
+}
+
+/**
+ * Sorts keys and removes duplicates.
+ */
+static void radix_sort_unique(std::vector<uint64_t> &keys)
+{
+    if (keys.size() < 2) {
+        return;
+    }
+    std::vector<uint64_t> tmp(keys.size());
+    radix_sort(&keys[0], &tmp[0], keys.size());
+    keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+}
+
+}; /* namespace pgraph */
+
+#endif /* _PGRAPH_RADIX_SORT_H_ */
@@ -0,0 +1,505 @@
+/**
+ * @file sais_omp.hpp
+ *
+ * @author agent@local
+ *
+ * Copyright 2026 agent. All rights reserved.
+ *
+ * OpenMP-parallel suffix and LCP array construction with the same contract
+ * as sais() from contrib/sais-lite-lcp. Suffixes are bucketed by their first
+ * two characters, the buckets are sorted concurrently using multikey
+ * quicksort, and the LCP array is computed with a chunked Kasai scan.
+ *
+ * The index type is a template parameter so tiles past 2^31 residues can be
+ * sorted with 64-bit indices. sais() only exists for int, so 64-bit buckets
+ * too repetitive for multikey quicksort are finished by prefix doubling.
+ * So is the text type: anything indexed like a character array will do,
+ * e.g. a text split across two ranges of memory, whose deep buckets are
+ * also finished by prefix doubling since sais() needs one string.
+ * sais_omp_sparse() sorts just a sample of the suffixes the same way.
+ *
+ * This is header-only so that it picks up the OpenMP flags of the program
+ * including it; without OpenMP it runs serially and gives the same result.
+ */
+#ifndef _PGRAPH_SAIS_OMP_H_
+#define _PGRAPH_SAIS_OMP_H_
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include <algorithm>
+#include <new>
+#include <utility>
+#include <vector>
+
+#include "sais.h"
+
+/* Multikey quicksort degrades quadratically on long periodic runs. A bucket
+ * needing more characters than this to resolve sends the whole text back to
+ * the serial sais() instead. */
+#ifndef SAIS_OMP_MAX_DEPTH
+#define SAIS_OMP_MAX_DEPTH 1024
+#endif
+
+namespace pgraph {
+
+/* character at depth d of suffix i; the end of the text sorts first */
+template <class Index, class Text>
+static inline int sais_omp_chr(const Text &T, Index n, Index i, Index d)
+{
+    return (i + d < n) ? int((unsigned char)T[i + d]) + 1 : 0;
+}
+
+/* compares suffixes a and b, both known to agree on their first d chars */
+template <class Index, class Text>
+static inline bool sais_omp_less(
+        const Text &T, Index n, Index a, Index b, Index d)
+{
+    for (;;) {
+        int ca = sais_omp_chr(T, n, a, d);
+        int cb = sais_omp_chr(T, n, b, d);
+        if (ca != cb) return ca < cb;
+        if (0 == ca) return a > b; /* not reached for distinct suffixes */
+        ++d;
+    }
+}
+
+/* multikey quicksort (Bentley and Sedgewick) of m suffixes sharing a prefix
+ * of length d; loops instead of recursing on the equal partition and
+ * returns false once the depth exceeds SAIS_OMP_MAX_DEPTH */
+template <class Index, class Text>
+static bool sais_omp_mkqs(
+        const Text &T, Index n, Index *a, Index m, Index d)
+{
+    while (m > 1) {
+        if (d > SAIS_OMP_MAX_DEPTH) {
+            return false;
+        }
+        if (m < 16) {
+            for (Index i = 1; i < m; ++i) {
+                Index v = a[i];
+                Index j = i;
+                while (j > 0 && sais_omp_less(T, n, v, a[j-1], d)) {
+                    a[j] = a[j-1];
+                    --j;
+                }
+                a[j] = v;
+            }
+            return true;
+        }
+
+        /* median of three */
+        int x = sais_omp_chr(T, n, a[0], d);
+        int y = sais_omp_chr(T, n, a[m/2], d);
+        int z = sais_omp_chr(T, n, a[m-1], d);
+        int pivot = (x < y) ? ((y < z) ? y : ((x < z) ? z : x))
+                            : ((x < z) ? x : ((y < z) ? z : y));
+
+        /* three-way partition into [<pivot][==pivot][>pivot] */
+        Index lt = 0;
+        Index i = 0;
+        Index gt = m;
+        while (i < gt) {
+            int c = sais_omp_chr(T, n, a[i], d);
+            if (c < pivot) {
+                std::swap(a[lt++], a[i++]);
+            }
+            else if (c > pivot) {
+                std::swap(a[i], a[--gt]);
+            }
+            else {
+                ++i;
+            }
+        }
+
+        if (!sais_omp_mkqs(T, n, a, lt, d)
+                || !sais_omp_mkqs(T, n, a + gt, m - gt, d)) {
+            return false;
+        }
+        if (0 == pivot) {
+            return true; /* at most one suffix can end here */
+        }
+        a += lt;
+        m = gt - lt;
+        ++d;
+    }
+
+    return true;
+}
+
+/* sais() finishes int arrays of one string whose buckets are too deep;
+ * returns 1 for 64-bit indices or any other text, which it cannot handle */
+static inline int sais_omp_serial(
+        const unsigned char * const &T, int *SA, int *LCP, int n)
+{
+    return sais(T, SA, LCP, n);
+}
+
+template <class Index, class Text>
+static inline int sais_omp_serial(
+        const Text &, Index *, Index *, Index)
+{
+    return 1;
+}
+
+/* only a character pointer can be missing */
+static inline bool sais_omp_missing(const unsigned char * const &T)
+{
+    return T == NULL;
+}
+
+template <class Text>
+static inline bool sais_omp_missing(const Text &)
+{
+    return false;
+}
+
+/* orders suffixes of a group by the rank of the suffix h characters on */
+template <class Index>
+struct sais_omp_key_less {
+    const std::vector<Index> &rank;
+    Index n;
+    Index h;
+    sais_omp_key_less(const std::vector<Index> &rank, Index n, Index h)
+        : rank(rank), n(n), h(h) {}
+    Index key(Index i) const { return (i + h < n) ? rank[i + h] : -1; }
+    bool operator()(Index a, Index b) const { return key(a) < key(b); }
+};
+
+/* orders whole suffixes, for buckets too deep for multikey quicksort */
+template <class Index, class Text>
+struct sais_omp_sparse_less {
+    const Text &T;
+    Index n;
+    sais_omp_sparse_less(const Text &T, Index n) : T(T), n(n) {}
+    bool operator()(Index a, Index b) const {
+        return sais_omp_less<Index>(T, n, a, b, 2);
+    }
+};
+
+/* Prefix doubling (Manber and Myers) of the groups SA[lb..rb] whose
+ * suffixes agree on their first h characters; every other suffix must
+ * already be in place. rank[i] is the last SA index of the group of
+ * suffix i, so doubling h only ever splits groups. */
+template <class Index>
+static void sais_omp_doubling(
+        Index *SA, Index n, Index h,
+        std::vector<std::pair<Index,Index> > &groups,
+        std::vector<Index> &rank)
+{
+#pragma omp parallel for schedule(static)
+    for (Index i = 0; i < n; ++i) {
+        rank[SA[i]] = i;
+    }
+    for (size_t g = 0; g < groups.size(); ++g) {
+        for (Index j = groups[g].first; j <= groups[g].second; ++j) {
+            rank[SA[j]] = groups[g].second;
+        }
+    }
+
+    while (!groups.empty()) {
+        sais_omp_key_less<Index> less(rank, n, h);
+        std::vector<std::vector<std::pair<Index,Index> > > split(groups.size());
+
+        /* sort and split every group before any rank changes */
+#pragma omp parallel for schedule(dynamic)
+        for (long g = 0; g < (long)groups.size(); ++g) {
+            Index lb = groups[g].first;
+            Index rb = groups[g].second;
+            std::sort(SA + lb, SA + rb + 1, less);
+            for (Index j = lb; j <= rb; ) {
+                Index k = j;
+                while (k < rb && less.key(SA[k+1]) == less.key(SA[j])) {
+                    ++k;
+                }
+                split[g].push_back(std::make_pair(j, k));
+                j = k + 1;
+            }
+        }
+
+        std::vector<std::pair<Index,Index> > next;
+        for (size_t g = 0; g < split.size(); ++g) {
+            for (size_t s = 0; s < split[g].size(); ++s) {
+                Index lb = split[g][s].first;
+                Index rb = split[g][s].second;
+                for (Index j = lb; j <= rb; ++j) {
+                    rank[SA[j]] = rb;
+                }
+                if (lb < rb) {
+                    next.push_back(split[g][s]);
+                }
+            }
+        }
+        groups.swap(next);
+        h *= 2;
+    }
+}
+
+/**
+ * Finds the suffix array SA and LCP array of T[0..n-1].
+ *
+ * LCP[0] is 0 and LCP[i] is the longest common prefix of the suffixes
+ * SA[i-1] and SA[i], exactly as computed by sais(). Highly repetitive text
+ * (see SAIS_OMP_MAX_DEPTH) is handed to sais() unchanged when Index is
+ * int and T is one string, and otherwise finished by prefix doubling.
+ * Inside an existing parallel region it runs on one thread.
+ *
+ * @param[in] T the text, a character pointer or anything T[i] reads
+ * @param[out] SA suffix array of at least n entries
+ * @param[out] LCP lcp array of at least n entries
+ * @param[in] n length of T
+ * @param[in] threads threads to sort with, 0 for all OpenMP threads
+ * @return 0 on success, -1 on invalid arguments, -2 on allocation failure
+ */
+template <class Index, class Text>
+static int sais_omp(const Text &T, Index *SA, Index *LCP, Index n,
+        int threads=0)
+{
+    const int SIGMA = 257; /* 256 characters plus end of text */
+    const int NBUCKETS = SIGMA * SIGMA;
+    int nthreads = 1;
+    bool too_deep = false;
+
+    if (sais_omp_missing(T) || (SA == NULL) || (LCP == NULL) || (n < 0)) {
+        return -1;
+    }
+    if (n <= 1) {
+        if (n == 1) {
+            SA[0] = 0;
+            LCP[0] = 0;
+        }
+        return 0;
+    }
+
+#ifdef _OPENMP
+    if (!omp_in_parallel()) {
+        nthreads = threads > 0 ? threads : omp_get_max_threads();
+    }
+#endif
+
+    try {
+        std::vector<Index> counts((size_t)nthreads * NBUCKETS, 0);
+        std::vector<Index> bucket_start(NBUCKETS + 1, 0);
+        std::vector<char> deep(NBUCKETS, 0);
+        std::vector<Index> rank(n);
+
+        /* bucket suffixes by their first two characters */
+#pragma omp parallel num_threads(nthreads)
+        {
+            int tid = 0;
+#ifdef _OPENMP
+            tid = omp_get_thread_num();
+#endif
+            Index *count = &counts[(size_t)tid * NBUCKETS];
+#pragma omp for schedule(static)
+            for (Index i = 0; i < n; ++i) {
+                ++count[sais_omp_chr<Index>(T, n, i, 0) * SIGMA
+                        + sais_omp_chr<Index>(T, n, i, 1)];
+            }
+#pragma omp single
+            {
+                Index sum = 0;
+                for (int b = 0; b < NBUCKETS; ++b) {
+                    bucket_start[b] = sum;
+                    for (int t = 0; t < nthreads; ++t) {
+                        Index c = counts[(size_t)t * NBUCKETS + b];
+                        counts[(size_t)t * NBUCKETS + b] = sum;
+                        sum += c;
+                    }
+                }
+                bucket_start[NBUCKETS] = sum;
+            }
+            /* same static schedule as the counting loop */
+#pragma omp for schedule(static)
+            for (Index i = 0; i < n; ++i) {
+                SA[count[sais_omp_chr<Index>(T, n, i, 0) * SIGMA
+                        + sais_omp_chr<Index>(T, n, i, 1)]++] = i;
+            }
+
+            /* sort each bucket past its two character prefix */
+#pragma omp for schedule(dynamic, 64)
+            for (int b = 0; b < NBUCKETS; ++b) {
+                Index size = bucket_start[b+1] - bucket_start[b];
+                if (size > 1
+                        && !sais_omp_mkqs<Index>(T, n, SA + bucket_start[b], size, 2)) {
+                    deep[b] = 1;
+#pragma omp atomic write
+                    too_deep = true;
+                }
+            }
+        }
+
+        if (too_deep) {
+            int status = sais_omp_serial(T, SA, LCP, n);
+            if (1 != status) {
+                return status;
+            }
+            std::vector<std::pair<Index,Index> > groups;
+            for (int b = 0; b < NBUCKETS; ++b) {
+                if (deep[b]) {
+                    groups.push_back(std::make_pair(
+                                bucket_start[b], bucket_start[b+1] - 1));
+                }
+            }
+            sais_omp_doubling<Index>(SA, n, 2, groups, rank);
+        }
+
+#pragma omp parallel num_threads(nthreads)
+        {
+#pragma omp for schedule(static)
+            for (Index i = 0; i < n; ++i) {
+                rank[SA[i]] = i;
+            }
+
+            /* Kasai et al over contiguous chunks of text positions; each
+             * chunk restarts with h=0, costing a few extra comparisons */
+            Index chunk = (n + nthreads - 1) / nthreads;
+#pragma omp for schedule(static, 1)
+            for (int t = 0; t < nthreads; ++t) {
+                Index beg = t * chunk;
+                Index end = std::min(n, beg + chunk);
+                Index h = 0;
+                for (Index i = beg; i < end; ++i) {
+                    Index r = rank[i];
+                    if (r > 0) {
+                        Index j = SA[r-1];
+                        while (i + h < n && j + h < n && T[i+h] == T[j+h]) {
+                            ++h;
+                        }
+                        LCP[r] = h;
+                        if (h > 0) --h;
+                    }
+                    else {
+                        LCP[0] = 0;
+                        h = 0;
+                    }
+                }
+            }
+        }
+    }
+    catch (const std::bad_alloc&) {
+        return -2;
+    }
+
+    return 0;
+}
+
+/**
+ * Sorts a sample of the suffixes of T[0..n-1] into the order they have in
+ * its suffix array, without sorting the rest.
+ *
+ * SA holds the m starting positions on entry, in any order. On return they
+ * are sorted, LCP[0] is 0 and LCP[i] is the longest common prefix of the
+ * suffixes SA[i-1] and SA[i]. The positions are bucketed and sorted by
+ * multikey quicksort as in sais_omp(); a bucket too deep for it is sorted
+ * by plain comparison, and the LCPs are compared directly, since Kasai's
+ * scan needs every suffix. Only m extra indices are allocated.
+ *
+ * @param[in] T the text, a character pointer or anything T[i] reads
+ * @param[in] n length of T
+ * @param[in,out] SA the m positions to sort
+ * @param[out] LCP lcp array of at least m entries
+ * @param[in] m number of positions
+ * @param[in] threads threads to sort with, 0 for all OpenMP threads
+ * @return 0 on success, -1 on invalid arguments, -2 on allocation failure
+ */
+template <class Index, class Text>
+static int sais_omp_sparse(const Text &T, Index n, Index *SA, Index *LCP,
+        Index m, int threads=0)
+{
+    const int SIGMA = 257; /* 256 characters plus end of text */
+    const int NBUCKETS = SIGMA * SIGMA;
+    int nthreads = 1;
+
+    if (sais_omp_missing(T) || (SA == NULL) || (LCP == NULL)
+            || (n < 0) || (m < 0) || (m > n)) {
+        return -1;
+    }
+    if (m <= 1) {
+        if (m == 1) {
+            LCP[0] = 0;
+        }
+        return 0;
+    }
+
+#ifdef _OPENMP
+    if (!omp_in_parallel()) {
+        nthreads = threads > 0 ? threads : omp_get_max_threads();
+    }
+#endif
+
+    try {
+        std::vector<Index> counts((size_t)nthreads * NBUCKETS, 0);
+        std::vector<Index> bucket_start(NBUCKETS + 1, 0);
+        std::vector<Index> positions(SA, SA + m);
+
+        /* bucket the positions by their first two characters */
+#pragma omp parallel num_threads(nthreads)
+        {
+            int tid = 0;
+#ifdef _OPENMP
+            tid = omp_get_thread_num();
+#endif
+            Index *count = &counts[(size_t)tid * NBUCKETS];
+#pragma omp for schedule(static)
+            for (Index k = 0; k < m; ++k) {
+                Index i = positions[k];
+                ++count[sais_omp_chr<Index>(T, n, i, 0) * SIGMA
+                        + sais_omp_chr<Index>(T, n, i, 1)];
+            }
+#pragma omp single
+            {
+                Index sum = 0;
+                for (int b = 0; b < NBUCKETS; ++b) {
+                    bucket_start[b] = sum;
+                    for (int t = 0; t < nthreads; ++t) {
+                        Index c = counts[(size_t)t * NBUCKETS + b];
+                        counts[(size_t)t * NBUCKETS + b] = sum;
+                        sum += c;
+                    }
+                }
+                bucket_start[NBUCKETS] = sum;
+            }
+            /* same static schedule as the counting loop */
+#pragma omp for schedule(static)
+            for (Index k = 0; k < m; ++k) {
+                Index i = positions[k];
+                SA[count[sais_omp_chr<Index>(T, n, i, 0) * SIGMA
+                        + sais_omp_chr<Index>(T, n, i, 1)]++] = i;
+            }
+
+            /* sort each bucket past its two character prefix */
+#pragma omp for schedule(dynamic, 64)
+            for (int b = 0; b < NBUCKETS; ++b) {
+                Index *a = SA + bucket_start[b];
+                Index size = bucket_start[b+1] - bucket_start[b];
+                if (size > 1 && !sais_omp_mkqs<Index>(T, n, a, size, 2)) {
+                    std::sort(a, a + size, sais_omp_sparse_less<Index,Text>(T, n));
+                }
+            }
+
+#pragma omp for schedule(dynamic, 1024)
+            for (Index k = 0; k < m; ++k) {
+                Index h = 0;
+                if (k > 0) {
+                    Index i = SA[k];
+                    Index j = SA[k-1];
+                    while (i + h < n && j + h < n && T[i+h] == T[j+h]) {
+                        ++h;
+                    }
+                }
+                LCP[k] = h;
+            }
+        }
+    }
+    catch (const std::bad_alloc&) {
+        return -2;
+    }
+
+    return 0;
+}
+
+}; /* namespace pgraph */
+
+#endif /* _PGRAPH_SAIS_OMP_H_ */
@@ -54,6 +54,7 @@
 #endif
 
 #include "sais.h"
+#include "sais_omp.hpp"
 
 using ::std::cout;
 using ::std::endl;
@@ -79,6 +80,17 @@ typedef concurrent_unordered_set<Pair> PairSet;
 typedef set<Pair> PairSet;
 #endif
 
+/* T held as two separate ranges, as align_parted_nxtval sorts a tile */
+struct SplitText {
+    const unsigned char *head;
+    const unsigned char *tail;
+    int len_head;
+
+    unsigned char operator[](long i) const {
+        return i < len_head ? head[i] : tail[i - len_head];
+    }
+};
+
 struct quad {
     int lcp;
     int lb;
@@ -249,7 +261,7 @@ static int sufcheck(const unsigned char *T, const int *SA, int n, int verbose) {
 }
 
 static void print_help(const char *progname, int status) {
-    fprintf(stderr, "usage: %s [-b] [-x] [-p] [-k window_size] [-c cutoff>=1] [-s sentinal] FILE\n\n", progname);
+    fprintf(stderr, "usage: %s [-a] [-b] [-x] [-p] [-k window_size] [-c cutoff>=1] [-s sentinal] FILE\n\n", progname);
     exit(status);
 }
 
@@ -276,6 +288,7 @@ int main(int argc, const char *argv[]) {
     int cutoff = 1;
     int k = 3;
     int bucket_traversal = 0;
+    int parallel_sa = 0;
     PairSet pairs;
     int count = 0;
     int count_generated = 0;
@@ -345,6 +358,9 @@ int main(int argc, const char *argv[]) {
         else if (strncmp(argv[i], "-b", 2) == 0) {
             bucket_traversal = 1;
         }
+        else if (strncmp(argv[i], "-a", 2) == 0) {
+            parallel_sa = 1;
+        }
         else if (strncmp(argv[i], "-x", 2) == 0) {
             validate = 1;
         }
@@ -369,6 +385,7 @@ int main(int argc, const char *argv[]) {
     printf("Parameters:\n");
     printf("x=%d (1 means validate SA, BWT)\n", validate);
     printf("b=%d (1 means bucket traversal)\n", bucket_traversal);
+    printf("a=%d (1 means parallel SA construction)\n", parallel_sa);
     printf("p=%d (1 means verbose print)\n", print);
     printf("s='%c' (sentinal specified)\n", sentinal == 0 ? '?' : sentinal);
     printf("c=%d (exact-match cutoff)\n", cutoff);
@@ -469,12 +486,100 @@ int main(int argc, const char *argv[]) {
     /* Construct the suffix array. */
     fprintf(stderr, "%s: %d bytes ... \n", fname, n);
     start = timer();
-    if(sais(T, SA, LCP, (int)n) != 0) {
-        fprintf(stderr, "%s: Cannot allocate memory.\n", argv[0]);
-        exit(EXIT_FAILURE);
+    if (parallel_sa) {
+        if (pgraph::sais_omp(T, SA, LCP, (int)n) != 0) {
+            fprintf(stderr, "%s: Cannot allocate memory.\n", argv[0]);
+            exit(EXIT_FAILURE);
+        }
+        finish = timer();
+        fprintf(stderr, "parallel SA: %.4f sec\n", finish-start);
+    }
+    else {
+        if(sais(T, SA, LCP, (int)n) != 0) {
+            fprintf(stderr, "%s: Cannot allocate memory.\n", argv[0]);
+            exit(EXIT_FAILURE);
+        }
+        finish = timer();
+        fprintf(stderr, "induced SA: %.4f sec\n", finish-start);
+    }
+
+    if (parallel_sa && validate) {
+        /* compare against the serial induced sort; the LCP arrays are also
+         * checked naively below, which is what decides correctness since
+         * sais() has been seen to undercount a few LCPs on tiny inputs */
+        int *SA_check = (int *)malloc((size_t)(n+1) * sizeof(int));
+        int *LCP_check = (int *)malloc((size_t)(n+1) * sizeof(int));
+        int lcp_diff = 0;
+        if ((SA_check == NULL) || (LCP_check == NULL)
+                || (sais(T, SA_check, LCP_check, (int)n) != 0)) {
+            fprintf(stderr, "%s: Cannot allocate memory.\n", argv[0]);
+            exit(EXIT_FAILURE);
+        }
+        fprintf(stderr, "parallel SA vs induced SA: ");
+        for (i = 0; i < n; ++i) {
+            if (SA[i] != SA_check[i]) {
+                fprintf(stderr, "SA[%d]=%d differs from %d\n",
+                        i, SA[i], SA_check[i]);
+                exit(EXIT_FAILURE);
+            }
+            if (LCP[i] != LCP_check[i]) {
+                ++lcp_diff;
+            }
+        }
+        fprintf(stderr, "Done. (%d LCP entries differ)\n", lcp_diff);
+
+        /* the same text split in two, whose deep buckets are finished by
+         * prefix doubling instead of sais() */
+        {
+            vector<unsigned char> tail(T + n/2, T + n);
+            SplitText split = { T, &tail[0], (int)(n/2) };
+            if (pgraph::sais_omp(split, SA_check, LCP_check, (int)n) != 0) {
+                fprintf(stderr, "%s: Cannot allocate memory.\n", argv[0]);
+                exit(EXIT_FAILURE);
+            }
+        }
+        fprintf(stderr, "split text SA vs parallel SA: ");
+        for (i = 0; i < n; ++i) {
+            if (SA[i] != SA_check[i] || LCP[i] != LCP_check[i]) {
+                fprintf(stderr, "SA[%d]=%d LCP %d differs from %d LCP %d\n",
+                        i, SA[i], LCP[i], SA_check[i], LCP_check[i]);
+                exit(EXIT_FAILURE);
+            }
+        }
+        fprintf(stderr, "Done.\n");
+
+        /* every third suffix sorted on its own, against the full SA with
+         * the rest dropped and their LCPs folded into the minimum */
+        {
+            int m = 0;
+            int lcp = 0;
+            for (i = 0; i < n; i += 3) {
+                SA_check[m++] = i;
+            }
+            if (pgraph::sais_omp_sparse(T, (int)n, SA_check, LCP_check, m) != 0) {
+                fprintf(stderr, "%s: Cannot allocate memory.\n", argv[0]);
+                exit(EXIT_FAILURE);
+            }
+            fprintf(stderr, "sampled SA vs parallel SA: ");
+            m = 0;
+            for (i = 0; i < n; ++i) {
+                lcp = (0 == i || LCP[i] < lcp) ? LCP[i] : lcp;
+                if (0 != SA[i] % 3) {
+                    continue;
+                }
+                if (SA[i] != SA_check[m] || (m > 0 && lcp != LCP_check[m])) {
+                    fprintf(stderr, "SA[%d]=%d LCP %d differs from %d LCP %d\n",
+                            m, SA[i], lcp, SA_check[m], LCP_check[m]);
+                    exit(EXIT_FAILURE);
+                }
+                ++m;
+                lcp = INT_MAX;
+            }
+            fprintf(stderr, "Done.\n");
+        }
+        free(SA_check);
+        free(LCP_check);
     }
-    finish = timer();
-    fprintf(stderr, "induced SA: %.4f sec\n", finish-start);
 
     /* naive BWT: */
     /* also "fix" the LCP array to clamp LCP's that are too long */
@@ -0,0 +1,322 @@
+/**
+ * @file test_esa_traversal.cpp
+ *
+ * Microbenchmark of the bottom-up ESA traversal used by SA_filter.
+ *
+ * Builds the enhanced suffix array of a large synthetic tile made of
+ * protein families (mutated copies of random sequences) and traverses it
+ * twice: once with child l-intervals kept in a vector inside every quad,
+ * as the traversal used to, and once with lcp_intervals from
+ * esa_traversal.hpp, which SA_filter uses. Heap allocations made by each
+ * traversal are counted by replacing the global operator new, and both
+ * must generate the same pairs.
+ *
+ * usage: test_esa_traversal [residues] [cutoff]
+ */
+#include "config.h"
+
+#include <sys/time.h>
+
+#include <cassert>
+#include <climits>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <stack>
+#include <string>
+#include <vector>
+
+#include "sais.h"
+
+#include "esa_traversal.hpp"
+#include "radix_sort.hpp"
+
+using namespace std;
+using namespace pgraph;
+
+static unsigned long allocations = 0;
+
+#if __cplusplus >= 201103L
+#define THROW_BAD_ALLOC
+#define THROW_NOTHING noexcept
+#else
+#define THROW_BAD_ALLOC throw(bad_alloc)
+#define THROW_NOTHING throw()
+#endif
+
+void* operator new(size_t size) THROW_BAD_ALLOC
+{
+    void *p = NULL;
+    ++allocations;
+    p = malloc(size ? size : 1);
+    if (NULL == p) {
+        throw bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void *p) THROW_NOTHING
+{
+    free(p);
+}
+
+#if __cplusplus >= 201402L
+void operator delete(void *p, size_t) THROW_NOTHING
+{
+    free(p);
+}
+#endif
+
+namespace {
+
+    double getTime()
+    {
+        timeval tv;
+        gettimeofday(&tv, NULL);
+        return tv.tv_sec + tv.tv_usec / 1000000.0;
+    }
+
+    struct Tile {
+        string T;
+        vector<int> SA;
+        vector<int> LCP;
+        vector<int> SID;
+        vector<int> SID_SA; /* SID of each suffix in SA order */
+        vector<unsigned char> BWT;
+        int bup_start;
+        int bup_stop;
+    };
+
+    /* the quad as it was, owning copies of its children */
+    struct old_quad {
+        int lcp;
+        int lb;
+        int rb;
+        vector<old_quad> children;
+
+        old_quad()
+            : lcp(0), lb(0), rb(INT_MAX), children() {}
+        old_quad(int lcp, int lb, int rb)
+            : lcp(lcp), lb(lb), rb(rb), children() {}
+        old_quad(int lcp, int lb, int rb, vector<old_quad> children)
+            : lcp(lcp), lb(lb), rb(rb), children(children) {}
+
+        bool empty() { return rb == INT_MAX; }
+    };
+
+    void make_tile(Tile &tile, long residues)
+    {
+        const char *alphabet = "ACDEFGHIKLMNPQRSTVWY";
+        int sid = 0;
+
+        srandom(0);
+        while ((long)tile.T.size() < residues) {
+            string base;
+            int length = 100 + random()%500;
+            int copies = 2 + random()%30;
+            for (int i=0; i<length; ++i) {
+                base += alphabet[random()%20];
+            }
+            for (int c=0; c<copies; ++c) {
+                for (int i=0; i<length; ++i) {
+                    tile.T += (random()%10 == 0) ? alphabet[random()%20] : base[i];
+                    tile.SID.push_back(sid);
+                }
+                tile.T += '$';
+                tile.SID.push_back(sid);
+                ++sid;
+            }
+        }
+
+        int n = tile.T.size();
+        vector<int> END(sid);
+        for (int i=0; i<n; ++i) {
+            if (tile.T[i] == '$') {
+                END[tile.SID[i]] = i;
+            }
+        }
+        tile.SA.resize(n+1);
+        tile.LCP.resize(n+1);
+        tile.BWT.resize(n);
+        tile.SID_SA.resize(n);
+        if (sais((const unsigned char*)tile.T.c_str(),
+                    &tile.SA[0], &tile.LCP[0], n) != 0) {
+            fprintf(stderr, "Cannot allocate memory.\n");
+            exit(EXIT_FAILURE);
+        }
+        for (int i=0; i<n; ++i) {
+            int len = END[tile.SID[tile.SA[i]]] - tile.SA[i];
+            if (tile.LCP[i] > len) tile.LCP[i] = len;
+            tile.BWT[i] = (tile.SA[i] > 0) ? tile.T[tile.SA[i]-1] : '$';
+            tile.SID_SA[i] = tile.SID[tile.SA[i]];
+        }
+        tile.LCP[n] = 0;
+        /* '$' sorts before all residues */
+        tile.bup_start = sid+1;
+        tile.bup_stop = n;
+        printf("tile: %d residues, %d sequences\n", n, sid);
+    }
+
+    void old_pair_check(unsigned long &count_generated, PairVec &pairs,
+            const Tile &tile, int i, int j)
+    {
+        int sidi = tile.SID_SA[i];
+        int sidj = tile.SID_SA[j];
+        if (tile.BWT[i] != tile.BWT[j] || tile.BWT[i] == '$') {
+            if (sidi != sidj) {
+                ++count_generated;
+                add_pair(pairs, sidi, sidj);
+            }
+        }
+    }
+
+    void old_process(unsigned long &count_generated, PairVec &pairs,
+            const Tile &tile, int lcp, int lb, int rb,
+            const vector<old_quad> &children, int cutoff)
+    {
+        int n_children = children.size();
+        int child_index = 0;
+
+        if (lcp < cutoff) return;
+
+        for (int i=lb; i<=rb; ++i) {
+            int j = i+1;
+            if (child_index < n_children) {
+                if (i >= children[child_index].lb) {
+                    j = children[child_index].rb+1;
+                    if (i >= children[child_index].rb) {
+                        ++child_index;
+                    }
+                }
+            }
+            for (/*nope*/; j<=rb; ++j) {
+                old_pair_check(count_generated, pairs, tile, i, j);
+            }
+        }
+    }
+
+    void traverse_old(unsigned long &count_generated, PairVec &pairs,
+            const Tile &tile, int cutoff)
+    {
+        const int *LCP = &tile.LCP[0];
+        stack<old_quad> the_stack;
+        old_quad last_interval;
+        the_stack.push(old_quad());
+        for (int i = tile.bup_start; i <= tile.bup_stop; ++i) {
+            int lb = i - 1;
+            while (LCP[i] < the_stack.top().lcp) {
+                the_stack.top().rb = i - 1;
+                last_interval = the_stack.top();
+                the_stack.pop();
+                old_process(count_generated, pairs, tile, last_interval.lcp,
+                        last_interval.lb, last_interval.rb,
+                        last_interval.children, cutoff);
+                lb = last_interval.lb;
+                if (LCP[i] <= the_stack.top().lcp) {
+                    last_interval.children.clear();
+                    the_stack.top().children.push_back(last_interval);
+                    last_interval = old_quad();
+                }
+            }
+            if (LCP[i] > the_stack.top().lcp) {
+                if (!last_interval.empty()) {
+                    last_interval.children.clear();
+                    the_stack.push(old_quad(LCP[i],lb,INT_MAX,vector<old_quad>(1, last_interval)));
+                    last_interval = old_quad();
+                }
+                else {
+                    the_stack.push(old_quad(LCP[i],lb,INT_MAX));
+                }
+            }
+        }
+        the_stack.top().rb = tile.bup_stop - 1;
+        old_process(count_generated, pairs, tile, the_stack.top().lcp,
+                the_stack.top().lb, the_stack.top().rb,
+                the_stack.top().children, cutoff);
+    }
+
+    /* the traversal of SA_filter, over the whole tile in one chunk */
+    void traverse_new(PairCounts &counts, PairVec &pairs,
+            const Tile &tile, int cutoff)
+    {
+        PairCompactor compactor;
+        lcp_intervals(counts, pairs, tile.bup_start, tile.bup_stop,
+                &tile.LCP[0], &tile.BWT[0], &tile.SID_SA[0], 0, '$',
+                cutoff, 0, compactor);
+    }
+
+}
+
+int main(int argc, char **argv)
+{
+    long residues = 4000000;
+    int cutoff = 8;
+    Tile tile;
+    PairVec warmup;
+    PairVec pairs_old;
+    PairVec pairs_new;
+    PairCounts counts_warmup;
+    PairCounts counts_new;
+    unsigned long generated_old = 0;
+    unsigned long allocations_old = 0;
+    unsigned long allocations_new = 0;
+    double time_old = 0.0;
+    double time_new = 0.0;
+
+    if (argc > 1) {
+        residues = atol(argv[1]);
+    }
+    if (argc > 2) {
+        cutoff = atoi(argv[2]);
+    }
+    if (residues <= 0 || cutoff <= 0) {
+        fprintf(stderr, "usage: %s [residues] [cutoff]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    make_tile(tile, residues);
+
+    /* a warm-up pass sizes both pair buffers, so only the allocations of
+     * the traversals themselves are counted; both start out empty */
+    traverse_new(counts_warmup, warmup, tile, cutoff);
+    pairs_old.reserve(2*warmup.size());
+    pairs_new.reserve(2*warmup.size());
+    PairVec().swap(warmup);
+
+    allocations = 0;
+    time_old = getTime();
+    traverse_old(generated_old, pairs_old, tile, cutoff);
+    time_old = getTime() - time_old;
+    allocations_old = allocations;
+
+    allocations = 0;
+    time_new = getTime();
+    traverse_new(counts_new, pairs_new, tile, cutoff);
+    time_new = getTime() - time_new;
+    allocations_new = allocations;
+
+    radix_sort_unique(pairs_old);
+    radix_sort_unique(pairs_new);
+
+    printf("child vectors: %g sec, %lu allocations\n",
+            time_old, allocations_old);
+    printf("child stack:   %g sec, %lu allocations\n",
+            time_new, allocations_new);
+    printf("generated pairs: %lu, unique pairs: %lu\n",
+            counts_new.generated, (unsigned long)pairs_new.size());
+
+    if (generated_old != counts_new.generated || pairs_old != pairs_new) {
+        printf("traversals disagree: %lu vs %lu generated, "
+                "%lu vs %lu unique pairs\n",
+                generated_old, counts_new.generated,
+                (unsigned long)pairs_old.size(),
+                (unsigned long)pairs_new.size());
+        return EXIT_FAILURE;
+    }
+    if (pairs_new.empty()) {
+        printf("no pairs generated, nothing was compared\n");
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,202 @@
+/**
+ * Times building parasail query profiles once per pair, which is what
+ * calling the aligner directly does, against once per query sequence with
+ * its partners aligned in a row, as align_parted_nxtval does with sorted
+ * candidate pairs. The profile variant is looked up by the name
+ * align_parted_nxtval uses, and all three must find the same scores.
+ *
+ * usage: test_query_profile [queries [partners [length [function [matrix]]]]]
+ */
+#include "config.h"
+
+#include <sys/time.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include <parasail.h>
+
+#include "alignment.hpp"
+
+using namespace std;
+using pgraph::profile_function;
+
+namespace {
+
+    const char *residues = "ARNDCQEGHILKMFPSTWYV";
+
+    double getTime()
+    {
+        timeval tv;
+        gettimeofday(&tv, NULL);
+        return tv.tv_sec + tv.tv_usec / 1000000.0;
+    }
+
+    /* lengths vary from half to one and a half times the given one */
+    string random_sequence(int length)
+    {
+        int len = length/2 + int(random() % (length + 1));
+        string s(len, 'A');
+        for (int i=0; i<len; ++i) {
+            s[i] = residues[random() % 20];
+        }
+        return s;
+    }
+
+    struct Timing {
+        long profiles;
+        double time_profile;
+        double time_total;
+        long score;
+
+        Timing() : profiles(0), time_profile(0.0), time_total(0.0), score(0) {}
+    };
+
+    void report(const char *name, const Timing &t)
+    {
+        fprintf(stdout, "%-12s profiles %8ld  build %10.6f sec  total %10.6f sec  score %ld\n",
+                name, t.profiles, t.time_profile, t.time_total, t.score);
+    }
+}
+
+
+int main(int argc, char **argv)
+{
+    int queries = 100;
+    int partners = 20;
+    int length = 300;
+    const char *function = "sw_stats_striped_16";
+    const char *matrix_name = "blosum62";
+    int open = 10;
+    int gap = 1;
+
+    if (argc > 1) {
+        queries = atoi(argv[1]);
+    }
+    if (argc > 2) {
+        partners = atoi(argv[2]);
+    }
+    if (argc > 3) {
+        length = atoi(argv[3]);
+    }
+    if (argc > 4) {
+        function = argv[4];
+    }
+    if (argc > 5) {
+        matrix_name = argv[5];
+    }
+
+    if (profile_function("sw_stats_striped_16")
+            != "sw_stats_striped_profile_16") {
+        fprintf(stderr, "profile_function(sw_stats_striped_16) is %s\n",
+                profile_function("sw_stats_striped_16").c_str());
+        return EXIT_FAILURE;
+    }
+
+    parasail_function_t *aligner = parasail_lookup_function(function);
+    string pfunction = profile_function(function);
+    parasail_pfunction_t *paligner = parasail_lookup_pfunction(pfunction.c_str());
+    parasail_pcreator_t *pcreator = parasail_lookup_pcreator(pfunction.c_str());
+    const parasail_matrix_t *matrix = parasail_matrix_lookup(matrix_name);
+    if (NULL == aligner) {
+        fprintf(stderr, "function %s not found\n", function);
+        return EXIT_FAILURE;
+    }
+    if (NULL == paligner || NULL == pcreator) {
+        fprintf(stderr, "%s has no profile variant %s\n",
+                function, pfunction.c_str());
+        return EXIT_FAILURE;
+    }
+    if (NULL == matrix) {
+        fprintf(stderr, "matrix %s not found\n", matrix_name);
+        return EXIT_FAILURE;
+    }
+
+    srandom(0);
+    vector<string> query(queries);
+    vector<vector<string> > partner(queries);
+    for (int q=0; q<queries; ++q) {
+        query[q] = random_sequence(length);
+        for (int p=0; p<partners; ++p) {
+            partner[q].push_back(random_sequence(length));
+        }
+    }
+
+    fprintf(stdout, "%d queries, %d partners each, length about %d, %s\n",
+            queries, partners, length, function);
+
+    Timing plain;
+    Timing per_pair;
+    Timing per_query;
+
+    /* the aligner builds its profile internally, so it is only timed */
+    {
+        Timing &t = plain;
+        double start = getTime();
+        for (int q=0; q<queries; ++q) {
+            for (int p=0; p<partners; ++p) {
+                const string &s2 = partner[q][p];
+                parasail_result_t *result = aligner(
+                        query[q].c_str(), query[q].size(),
+                        s2.c_str(), s2.size(), open, gap, matrix);
+                t.score += result->score;
+                parasail_result_free(result);
+            }
+        }
+        t.time_total = getTime() - start;
+        report("aligner", t);
+    }
+
+    {
+        Timing &t = per_pair;
+        double start = getTime();
+        for (int q=0; q<queries; ++q) {
+            for (int p=0; p<partners; ++p) {
+                const string &s2 = partner[q][p];
+                double tp = getTime();
+                parasail_profile_t *profile = pcreator(
+                        query[q].c_str(), query[q].size(), matrix);
+                t.time_profile += getTime() - tp;
+                ++t.profiles;
+                parasail_result_t *result = paligner(
+                        profile, s2.c_str(), s2.size(), open, gap);
+                t.score += result->score;
+                parasail_result_free(result);
+                parasail_profile_free(profile);
+            }
+        }
+        t.time_total = getTime() - start;
+        report("per pair", t);
+    }
+
+    {
+        Timing &t = per_query;
+        double start = getTime();
+        for (int q=0; q<queries; ++q) {
+            double tp = getTime();
+            parasail_profile_t *profile = pcreator(
+                    query[q].c_str(), query[q].size(), matrix);
+            t.time_profile += getTime() - tp;
+            ++t.profiles;
+            for (int p=0; p<partners; ++p) {
+                const string &s2 = partner[q][p];
+                parasail_result_t *result = paligner(
+                        profile, s2.c_str(), s2.size(), open, gap);
+                t.score += result->score;
+                parasail_result_free(result);
+            }
+            parasail_profile_free(profile);
+        }
+        t.time_total = getTime() - start;
+        report("per query", t);
+    }
+
+    if (per_pair.score != plain.score || per_query.score != plain.score) {
+        fprintf(stderr, "profile scores differ from %s\n", function);
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}